@@ -0,0 +1,509 @@
+/*
+ * Micro-benchmark for the bracket logic of the Bot Level Brackets module.
+ *
+ * Builds the module's world-independent code (src/mod-player-bot-level-brackets-core.h) against a
+ * synthetic bot population: a fake player registry stands in for ObjectAccessor and the playerbots
+ * manager, and a fake character database supplies the character_social and guild tracker rows.
+ * Each phase of a distribution cycle is timed and its heap allocations are counted, for 1k, 10k
+ * and 50k bots by default.
+ *
+ * Build and run from the module root (no AzerothCore sources needed):
+ *
+ *     g++ -std=c++17 -O2 -Iapps/bench -Isrc apps/bench/bracket_bench.cpp -o bracket_bench
+ *     ./bracket_bench --bots=1000,10000,50000 --horde=0.5 --dk=0.1 --guild=0.05 --friend=0.02
+ *
+ * Options (all optional):
+ *     --bots=N[,N...]   Population sizes to run.
+ *     --horde=F         Share of Horde bots.
+ *     --dk=F            Share of Death Knights (levels 55 and up).
+ *     --maxlevel=F      Share of bots at the maximum level.
+ *     --stray=F         Share of bots above the maximum level, i.e. outside all brackets.
+ *     --guild=F         Share of bots in a guild with real players.
+ *     --friend=F        Share of bots on a real player's friends list.
+ *     --exclude=F       Share of bots on the exclusion name list.
+ *     --repeat=N        Runs per population; the fastest run of each phase is reported.
+ *     --seed=N          Random seed.
+ */
+
+#include "mod-player-bot-level-brackets-core.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+// -----------------------------------------------------------------------------
+// ALLOCATION COUNTING
+// -----------------------------------------------------------------------------
+// GCC cannot see that the replacement operator new below allocates with malloc.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static std::atomic<uint64> g_AllocCount{0};
+static std::atomic<uint64> g_AllocBytes{0};
+
+void* operator new(std::size_t size)
+{
+    g_AllocCount.fetch_add(1, std::memory_order_relaxed);
+    g_AllocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// -----------------------------------------------------------------------------
+// SYNTHETIC WORLD
+// -----------------------------------------------------------------------------
+struct BenchOptions
+{
+    std::vector<uint32> populations = { 1000, 10000, 50000 };
+    double hordeShare = 0.5;
+    double deathKnightShare = 0.1;
+    double maxLevelShare = 0.2;
+    double strayShare = 0.05;
+    double guildShare = 0.05;
+    double friendShare = 0.02;
+    double excludeShare = 0.001;
+    uint32 repeat = 5;
+    uint32 seed = 1;
+};
+
+struct SyntheticBot
+{
+    uint32 guid;
+    uint8 teamId;
+    uint8 classGroup;
+    uint8 level;
+    uint32 guildId;
+};
+
+// Stands in for ObjectAccessor: bots by GUID counter.
+struct FakePlayerRegistry
+{
+    std::unordered_map<uint32, SyntheticBot> players;
+
+    const SyntheticBot* Find(uint32 guid) const
+    {
+        auto itr = players.find(guid);
+        return itr != players.end() ? &itr->second : nullptr;
+    }
+};
+
+// Stands in for the character database: the rows the module loads at startup.
+struct FakeCharacterDatabase
+{
+    std::vector<std::pair<uint32, uint32>> characterSocial;  ///< (owner, friend), flags = 1
+    std::vector<uint32> guildTracker;                        ///< guild_id with has_real_players = 1
+};
+
+struct BenchClock
+{
+    static uint32 Now()
+    {
+        return static_cast<uint32>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+using BenchPendingResetQueue = BasicPendingResetQueue<uint32, BenchClock>;
+
+static constexpr uint8 BENCH_MIN_LEVEL = 1;
+static constexpr uint8 BENCH_MAX_LEVEL = 80;
+static constexpr uint32 BENCH_REAL_PLAYER_GUID_BASE = 10000000;
+
+
+/**
+ * @brief Returns the bracket layout shipped in the default configuration.
+ */
+static std::vector<LevelRangeConfig> DefaultRanges()
+{
+    std::vector<LevelRangeConfig> ranges(9);
+    for (uint8 i = 0; i < 9; ++i)
+    {
+        ranges[i].lower = (i == 0 ? 1 : i * 10);
+        ranges[i].upper = (i < 8 ? i * 10 + 9 : BENCH_MAX_LEVEL);
+        ranges[i].desiredPercent = 11;
+    }
+    return ranges;
+}
+
+
+/**
+ * @brief Generates the synthetic population and the database rows that go with it.
+ */
+static void BuildWorld(const BenchOptions& options, uint32 population, std::mt19937& rng,
+    FakePlayerRegistry& registry, FakeCharacterDatabase& db, std::unordered_set<uint32>& excluded)
+{
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<uint32> anyLevel(BENCH_MIN_LEVEL, BENCH_MAX_LEVEL);
+    std::uniform_int_distribution<uint32> deathKnightLevel(55, BENCH_MAX_LEVEL);
+    std::uniform_int_distribution<uint32> strayLevel(BENCH_MAX_LEVEL + 1, BENCH_MAX_LEVEL + 10);
+    std::uniform_int_distribution<uint32> guild(1, std::max<uint32>(1, population / 50));
+
+    registry.players.reserve(population);
+    for (uint32 guid = 1; guid <= population; ++guid)
+    {
+        SyntheticBot bot;
+        bot.guid = guid;
+        bot.teamId = chance(rng) < options.hordeShare ? BRACKET_TEAM_HORDE : BRACKET_TEAM_ALLIANCE;
+        bot.classGroup = chance(rng) < options.deathKnightShare ? BRACKET_CLASS_GROUP_DEATH_KNIGHT : BRACKET_CLASS_GROUP_DEFAULT;
+        double roll = chance(rng);
+        if (roll < options.strayShare)
+        {
+            bot.level = static_cast<uint8>(strayLevel(rng));
+        }
+        else if (roll < options.strayShare + options.maxLevelShare)
+        {
+            bot.level = BENCH_MAX_LEVEL;
+        }
+        else
+        {
+            bot.level = static_cast<uint8>(bot.classGroup == BRACKET_CLASS_GROUP_DEATH_KNIGHT ? deathKnightLevel(rng) : anyLevel(rng));
+        }
+        bot.guildId = guild(rng);
+        registry.players.emplace(guid, bot);
+
+        if (chance(rng) < options.friendShare)
+        {
+            db.characterSocial.emplace_back(BENCH_REAL_PLAYER_GUID_BASE + guid % 997, guid);
+        }
+        if (chance(rng) < options.excludeShare)
+        {
+            excluded.insert(guid);
+        }
+    }
+
+    // Enough guilds with real players that roughly guildShare of the bots end up in one.
+    uint32 guildCount = std::max<uint32>(1, population / 50);
+    for (uint32 guildId = 1; guildId <= guildCount; ++guildId)
+    {
+        if (chance(rng) < options.guildShare)
+        {
+            db.guildTracker.push_back(guildId);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// PHASES
+// -----------------------------------------------------------------------------
+enum BenchPhase
+{
+    PHASE_CONFIG,
+    PHASE_DB_LOAD,
+    PHASE_CENSUS,
+    PHASE_COUNTS,
+    PHASE_COLLECT,
+    PHASE_PLAN,
+    PHASE_ORDER,
+    PHASE_DRAIN,
+    MAX_BENCH_PHASES
+};
+
+static char const* const PhaseNames[MAX_BENCH_PHASES] =
+{
+    "config (clamp + lookup tables)",
+    "db load (friends + guilds)",
+    "census build",
+    "census bracket counts",
+    "collect + classify",
+    "plan redistribution",
+    "pending processing order",
+    "pending drain",
+};
+
+struct PhaseResult
+{
+    double ms = 0.0;
+    uint64 allocs = 0;
+    uint64 bytes = 0;
+};
+
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(PhaseResult& result) : m_result(result),
+        m_allocs(g_AllocCount.load()), m_bytes(g_AllocBytes.load()), m_start(std::chrono::steady_clock::now()) {}
+
+    ~PhaseTimer()
+    {
+        m_result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+        m_result.allocs = g_AllocCount.load() - m_allocs;
+        m_result.bytes = g_AllocBytes.load() - m_bytes;
+    }
+
+private:
+    PhaseResult& m_result;
+    uint64 m_allocs;
+    uint64 m_bytes;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+
+/**
+ * @brief Runs one distribution cycle over the synthetic world, mirroring the module's phases.
+ */
+static void RunCycle(const FakePlayerRegistry& registry, const FakeCharacterDatabase& db,
+    const std::unordered_set<uint32>& excluded, PhaseResult (&results)[MAX_BENCH_PHASES])
+{
+    std::vector<LevelRangeConfig> ranges[2] = { DefaultRanges(), DefaultRanges() };
+    uint8 numRanges = static_cast<uint8>(ranges[0].size());
+    BracketLookupTables lookup;
+    {
+        PhaseTimer timer(results[PHASE_CONFIG]);
+        for (uint8 teamId = BRACKET_TEAM_ALLIANCE; teamId <= BRACKET_TEAM_HORDE; ++teamId)
+        {
+            ClampAndBalanceRanges(ranges[teamId], numRanges, BENCH_MIN_LEVEL, BENCH_MAX_LEVEL);
+            lookup.Rebuild(teamId, ranges[teamId], numRanges, BENCH_MIN_LEVEL, BENCH_MAX_LEVEL);
+        }
+    }
+
+    std::unordered_map<uint32, uint32> friendRefs;
+    std::unordered_set<uint64> friendPairs;
+    std::unordered_set<uint32> realPlayerGuilds;
+    {
+        PhaseTimer timer(results[PHASE_DB_LOAD]);
+        for (const auto& row : db.characterSocial)
+        {
+            if (friendPairs.insert((static_cast<uint64>(row.first) << 32) | row.second).second)
+            {
+                ++friendRefs[row.second];
+            }
+        }
+        realPlayerGuilds.insert(db.guildTracker.begin(), db.guildTracker.end());
+    }
+
+    uint32 byLevel[2][BRACKET_LEVEL_SLOTS] = {};
+    std::vector<uint32> censusGuids;
+    {
+        PhaseTimer timer(results[PHASE_CENSUS]);
+        censusGuids.reserve(registry.players.size());
+        for (const auto& itr : registry.players)
+        {
+            ++byLevel[itr.second.teamId][itr.second.level];
+            censusGuids.push_back(itr.first);
+        }
+    }
+
+    std::vector<int> deficits[2];
+    uint32 totals[2] = {};
+    {
+        PhaseTimer timer(results[PHASE_COUNTS]);
+        for (uint8 teamId = BRACKET_TEAM_ALLIANCE; teamId <= BRACKET_TEAM_HORDE; ++teamId)
+        {
+            totals[teamId] = GetBracketCountsFromHistogram(byLevel[teamId], ranges[teamId], numRanges, deficits[teamId]);
+            for (uint8 i = 0; i < numRanges; ++i)
+            {
+                int desired = static_cast<int>(ranges[teamId][i].desiredPercent / 100.0 * totals[teamId] + 0.5);
+                deficits[teamId][i] = desired - deficits[teamId][i];
+            }
+        }
+    }
+
+    BenchPendingResetQueue flagged;
+    std::vector<std::vector<uint32>> botsByRange[2];
+    std::vector<int> actualCounts[2];
+    {
+        PhaseTimer timer(results[PHASE_COLLECT]);
+        for (uint8 teamId = BRACKET_TEAM_ALLIANCE; teamId <= BRACKET_TEAM_HORDE; ++teamId)
+        {
+            botsByRange[teamId].assign(numRanges, std::vector<uint32>());
+            actualCounts[teamId].assign(numRanges, 0);
+        }
+        for (uint32 guid : censusGuids)
+        {
+            const SyntheticBot* bot = registry.Find(guid);
+            if (!bot)
+            {
+                continue;
+            }
+            if (excluded.count(guid) || realPlayerGuilds.count(bot->guildId) || friendRefs.count(guid))
+            {
+                continue;
+            }
+            int rangeIndex = lookup.BracketOf(bot->teamId, bot->level);
+            if (rangeIndex >= 0)
+            {
+                ++actualCounts[bot->teamId][rangeIndex];
+                botsByRange[bot->teamId][rangeIndex].push_back(guid);
+                continue;
+            }
+            int targetRange = lookup.NearestBracket(bot->teamId, bot->classGroup, bot->level);
+            if (targetRange >= 0)
+            {
+                flagged.Push({ guid, targetRange, ranges[bot->teamId].data(), bot->teamId });
+            }
+        }
+    }
+
+    {
+        PhaseTimer timer(results[PHASE_PLAN]);
+        for (uint8 teamId = BRACKET_TEAM_ALLIANCE; teamId <= BRACKET_TEAM_HORDE; ++teamId)
+        {
+            std::vector<int>& actual = actualCounts[teamId];
+            std::vector<int> desired(numRanges);
+            std::vector<std::array<std::vector<uint32>, MAX_BRACKET_CLASS_GROUPS>> candidates(numRanges);
+            std::vector<std::array<uint32, MAX_BRACKET_CLASS_GROUPS>> movable(numRanges);
+            for (uint8 i = 0; i < numRanges; ++i)
+            {
+                desired[i] = static_cast<int>(ranges[teamId][i].desiredPercent / 100.0 * totals[teamId] + 0.5);
+            }
+            for (uint8 i = 0; i < numRanges; ++i)
+            {
+                movable[i].fill(0);
+                if (actual[i] <= desired[i])
+                {
+                    continue;
+                }
+                for (uint32 guid : botsByRange[teamId][i])
+                {
+                    uint8 group = registry.Find(guid)->classGroup;
+                    candidates[i][group].push_back(guid);
+                    ++movable[i][group];
+                }
+            }
+
+            for (const RebalanceMove& move : PlanMinCostRebalance(ranges[teamId], numRanges, actual, desired, movable))
+            {
+                std::vector<uint32>& pool = candidates[move.from][move.group];
+                const LevelRangeConfig& target = ranges[teamId][move.to];
+                std::sort(pool.begin(), pool.end(), [&](uint32 a, uint32 b)
+                {
+                    return GetLevelDistanceToRange(registry.Find(a)->level, target, move.group) <
+                        GetLevelDistanceToRange(registry.Find(b)->level, target, move.group);
+                });
+                uint32 count = std::min<uint32>(move.count, pool.size());
+                for (uint32 k = 0; k < count; ++k)
+                {
+                    flagged.Push({ pool[k], move.to, ranges[teamId].data(), teamId });
+                }
+                pool.erase(pool.begin(), pool.begin() + count);
+                actual[move.from] -= count;
+                actual[move.to] += count;
+            }
+        }
+    }
+
+    std::vector<uint32> order;
+    {
+        PhaseTimer timer(results[PHASE_ORDER]);
+        order = flagged.BuildProcessingOrder(deficits);
+    }
+
+    {
+        PhaseTimer timer(results[PHASE_DRAIN]);
+        for (uint32 guid : order)
+        {
+            const BenchPendingResetQueue::Entry* entry = flagged.Find(guid);
+            if (!entry || !registry.Find(guid))
+            {
+                continue;
+            }
+            flagged.Remove(guid);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// ENTRY POINT
+// -----------------------------------------------------------------------------
+static bool ParseOption(const std::string& arg, BenchOptions& options)
+{
+    size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+    {
+        return false;
+    }
+    std::string name = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+    if (name == "bots")
+    {
+        options.populations.clear();
+        std::istringstream f(value);
+        std::string s;
+        while (getline(f, s, ','))
+        {
+            options.populations.push_back(static_cast<uint32>(std::stoul(s)));
+        }
+        return !options.populations.empty();
+    }
+    if (name == "repeat" || name == "seed")
+    {
+        (name == "repeat" ? options.repeat : options.seed) = static_cast<uint32>(std::stoul(value));
+        return true;
+    }
+    double share = std::stod(value);
+    if (name == "horde") options.hordeShare = share;
+    else if (name == "dk") options.deathKnightShare = share;
+    else if (name == "maxlevel") options.maxLevelShare = share;
+    else if (name == "stray") options.strayShare = share;
+    else if (name == "guild") options.guildShare = share;
+    else if (name == "friend") options.friendShare = share;
+    else if (name == "exclude") options.excludeShare = share;
+    else return false;
+    return true;
+}
+
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!ParseOption(argv[i], options))
+        {
+            std::fprintf(stderr, "Unknown option: %s (see the comment at the top of bracket_bench.cpp)\n", argv[i]);
+            return 1;
+        }
+    }
+
+    for (uint32 population : options.populations)
+    {
+        std::mt19937 rng(options.seed);
+        FakePlayerRegistry registry;
+        FakeCharacterDatabase db;
+        std::unordered_set<uint32> excluded;
+        BuildWorld(options, population, rng, registry, db, excluded);
+
+        PhaseResult best[MAX_BENCH_PHASES];
+        for (uint32 run = 0; run < std::max<uint32>(1, options.repeat); ++run)
+        {
+            PhaseResult results[MAX_BENCH_PHASES];
+            RunCycle(registry, db, excluded, results);
+            for (int phase = 0; phase < MAX_BENCH_PHASES; ++phase)
+            {
+                if (run == 0 || results[phase].ms < best[phase].ms)
+                {
+                    best[phase] = results[phase];
+                }
+            }
+        }
+
+        std::printf("\n%u bots (%zu friendships, %zu guilds with real players, %zu excluded)\n",
+            population, db.characterSocial.size(), db.guildTracker.size(), excluded.size());
+        std::printf("  %-32s %12s %10s %12s\n", "phase", "ms", "allocs", "bytes");
+        for (int phase = 0; phase < MAX_BENCH_PHASES; ++phase)
+        {
+            std::printf("  %-32s %12.3f %10llu %12llu\n", PhaseNames[phase], best[phase].ms,
+                static_cast<unsigned long long>(best[phase].allocs), static_cast<unsigned long long>(best[phase].bytes));
+        }
+    }
+    return 0;
+}
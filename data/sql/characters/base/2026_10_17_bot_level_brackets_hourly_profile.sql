@@ -0,0 +1,15 @@
+-- Bot Level Brackets Hourly Profile Table
+-- Real players per bracket for each hour of the day, learned by dynamic distribution when
+-- BotLevelBrackets.Dynamic.Profile.Enabled is set, so the profile survives restarts.
+
+DROP TABLE IF EXISTS `bot_level_brackets_hourly_profile`;
+
+CREATE TABLE `bot_level_brackets_hourly_profile` (
+  `team_id` tinyint(3) unsigned NOT NULL COMMENT '0 = Alliance, 1 = Horde',
+  `hour` tinyint(3) unsigned NOT NULL COMMENT 'Hour of the day, server local time',
+  `range_lower` tinyint(3) unsigned NOT NULL COMMENT 'Lower level bound of the bracket',
+  `range_upper` tinyint(3) unsigned NOT NULL COMMENT 'Upper level bound of the bracket',
+  `real_players` float NOT NULL DEFAULT '0' COMMENT 'Average real players in the bracket during this hour',
+  `samples` int(10) unsigned NOT NULL DEFAULT '0' COMMENT 'Distribution checks folded into the average',
+  PRIMARY KEY (`team_id`, `hour`, `range_lower`, `range_upper`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='Real player bracket profile per hour of the day';
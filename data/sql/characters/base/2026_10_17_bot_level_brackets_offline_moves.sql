@@ -0,0 +1,11 @@
+-- Bot Level Brackets Offline Moves Table
+-- This table lists random bots whose level was rewritten while they were offline. Their spells,
+-- talents and gear are regenerated for the new level the next time they log in.
+
+DROP TABLE IF EXISTS `bot_level_brackets_offline_moves`;
+
+CREATE TABLE `bot_level_brackets_offline_moves` (
+  `guid` int(10) unsigned NOT NULL COMMENT 'Bot character GUID',
+  `moved_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP COMMENT 'When the level was rewritten',
+  PRIMARY KEY (`guid`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='Bots moved offline waiting for a loadout refresh';
@@ -0,0 +1,27 @@
+-- Bot Level Brackets Persistence Tables
+-- These tables keep the pending level resets and the last per-bracket census across restarts,
+-- so the module resumes where it left off instead of rescanning and re-flagging every bot.
+
+DROP TABLE IF EXISTS `bot_level_brackets_pending_resets`;
+
+CREATE TABLE `bot_level_brackets_pending_resets` (
+  `guid` int(10) unsigned NOT NULL COMMENT 'Bot character GUID',
+  `team_id` tinyint(3) unsigned NOT NULL COMMENT '0 = Alliance, 1 = Horde',
+  `range_lower` tinyint(3) unsigned NOT NULL COMMENT 'Lower level bound of the target bracket',
+  `range_upper` tinyint(3) unsigned NOT NULL COMMENT 'Upper level bound of the target bracket',
+  `enqueued_at` int(10) unsigned NOT NULL DEFAULT '0' COMMENT 'Unix time when the bot was first flagged',
+  PRIMARY KEY (`guid`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='Bots waiting for a bot level bracket reset';
+
+DROP TABLE IF EXISTS `bot_level_brackets_census`;
+
+CREATE TABLE `bot_level_brackets_census` (
+  `team_id` tinyint(3) unsigned NOT NULL COMMENT '0 = Alliance, 1 = Horde',
+  `range_index` tinyint(3) unsigned NOT NULL COMMENT 'Bracket index, 0-based',
+  `range_lower` tinyint(3) unsigned NOT NULL COMMENT 'Lower level bound of the bracket',
+  `range_upper` tinyint(3) unsigned NOT NULL COMMENT 'Upper level bound of the bracket',
+  `bot_count` int(10) unsigned NOT NULL DEFAULT '0' COMMENT 'Random bots online in the bracket',
+  `desired_count` int(10) unsigned NOT NULL DEFAULT '0' COMMENT 'Desired random bots in the bracket',
+  `saved_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP COMMENT 'When the census was saved',
+  PRIMARY KEY (`team_id`, `range_index`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='Last bot level bracket census saved by the module';
@@ -0,0 +1,1153 @@
+#ifndef MOD_BOT_LEVEL_BRACKETS_CORE_H
+#define MOD_BOT_LEVEL_BRACKETS_CORE_H
+
+// Bracket logic of the Bot Level Brackets module that does not touch the world, the playerbots
+// module or the database. It only depends on Define.h, so the benchmark in apps/bench can build
+// it against a synthetic bot population.
+
+#include "Define.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Faction indices, matching TEAM_ALLIANCE and TEAM_HORDE.
+static constexpr uint8 BRACKET_TEAM_ALLIANCE = 0;
+static constexpr uint8 BRACKET_TEAM_HORDE = 1;
+
+// One slot per possible character level.
+static constexpr uint32 BRACKET_LEVEL_SLOTS = 256;
+
+// -----------------------------------------------------------------------------
+// LEVEL RANGE CONFIGURATION
+// -----------------------------------------------------------------------------
+// Same boundaries for both factions; only desired percentages differ.
+struct LevelRangeConfig
+{
+    uint8 lower;         ///< Lower bound (inclusive)
+    uint8 upper;         ///< Upper bound (inclusive)
+    uint8 desiredPercent;///< Desired percentage of bots in this range
+};
+
+
+/**
+ * @brief Clamps the brackets of one faction to the random bot level limits and tops their percentages up to 100.
+ *
+ * Brackets whose lower bound ends up above their upper bound get a desired percentage of zero.
+ * If the percentages of the remaining brackets sum to more than zero but less than 100, they are
+ * increased one at a time, round-robin, until the sum reaches 100.
+ *
+ * @param ranges The brackets of one faction.
+ * @param numRanges The number of brackets in use.
+ * @param minLevel Minimum random bot level.
+ * @param maxLevel Maximum random bot level.
+ * @return uint32 The sum of the desired percentages after clamping and before topping up.
+ */
+inline uint32 ClampAndBalanceRanges(std::vector<LevelRangeConfig>& ranges, uint8 numRanges, uint8 minLevel, uint8 maxLevel)
+{
+    for (uint8 i = 0; i < numRanges; ++i)
+    {
+        if (ranges[i].lower < minLevel)
+        {
+            ranges[i].lower = minLevel;
+        }
+        if (ranges[i].upper > maxLevel)
+        {
+            ranges[i].upper = maxLevel;
+        }
+        if (ranges[i].lower > ranges[i].upper)
+        {
+            ranges[i].desiredPercent = 0;
+        }
+    }
+
+    uint32 total = 0;
+    for (uint8 i = 0; i < numRanges; ++i)
+    {
+        total += ranges[i].desiredPercent;
+    }
+    if (total != 100 && total > 0)
+    {
+        int missing = 100 - total;
+        while (missing > 0)
+        {
+            for (uint8 i = 0; i < numRanges && missing > 0; ++i)
+            {
+                if (ranges[i].lower <= ranges[i].upper && ranges[i].desiredPercent > 0)
+                {
+                    ranges[i].desiredPercent++;
+                    missing--;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+
+/**
+ * @brief Returns the number of bots per bracket from a per-level histogram.
+ *
+ * Counts are taken from prefix sums, so the cost depends on the number of levels and brackets
+ * rather than on the number of bots.
+ *
+ * @param byLevel Bot count per level.
+ * @param ranges The brackets of the faction.
+ * @param numRanges The number of brackets in use.
+ * @param counts Output vector, resized to numRanges, receiving the bot count per bracket.
+ * @return uint32 The total number of bots in the histogram, in a bracket or not.
+ */
+inline uint32 GetBracketCountsFromHistogram(const uint32 (&byLevel)[BRACKET_LEVEL_SLOTS], const std::vector<LevelRangeConfig>& ranges,
+    uint8 numRanges, std::vector<int>& counts)
+{
+    counts.assign(numRanges, 0);
+
+    // prefix[L] holds the number of bots with a level below L.
+    uint32 prefix[BRACKET_LEVEL_SLOTS + 1];
+    prefix[0] = 0;
+    for (uint32 level = 0; level < BRACKET_LEVEL_SLOTS; ++level)
+    {
+        prefix[level + 1] = prefix[level] + byLevel[level];
+    }
+
+    for (uint8 i = 0; i < numRanges; ++i)
+    {
+        if (ranges[i].lower > ranges[i].upper)
+        {
+            continue;
+        }
+        counts[i] = static_cast<int>(prefix[ranges[i].upper + 1] - prefix[ranges[i].lower]);
+    }
+
+    return prefix[BRACKET_LEVEL_SLOTS];
+}
+
+// -----------------------------------------------------------------------------
+// BRACKET LOOKUP TABLES
+// -----------------------------------------------------------------------------
+// Per-faction answers to "which bracket holds this level" and "which bracket is nearest",
+// precomputed for every level so classifying a player is a single array load.
+enum BracketClassGroup : uint8
+{
+    BRACKET_CLASS_GROUP_DEFAULT      = 0,
+    BRACKET_CLASS_GROUP_DEATH_KNIGHT = 1,
+    MAX_BRACKET_CLASS_GROUPS         = 2
+};
+
+class BracketLookupTables
+{
+public:
+    /**
+     * @brief Rebuilds the tables of one faction.
+     *
+     * For the nearest bracket, ties go to the lowest bracket index, and Death Knights only
+     * consider brackets whose upper bound is at least 55.
+     *
+     * @param teamId The faction (BRACKET_TEAM_ALLIANCE or BRACKET_TEAM_HORDE).
+     * @param ranges The brackets of that faction.
+     * @param numRanges The number of brackets in use.
+     * @param minLevel Minimum random bot level; lower levels are outside all brackets.
+     * @param maxLevel Maximum random bot level; higher levels are outside all brackets.
+     */
+    void Rebuild(uint8 teamId, const std::vector<LevelRangeConfig>& ranges, uint8 numRanges, uint8 minLevel, uint8 maxLevel)
+    {
+        for (uint32 level = 0; level < BRACKET_LEVEL_SLOTS; ++level)
+        {
+            m_bracketByLevel[teamId][level] = -1;
+            if (level >= minLevel && level <= maxLevel)
+            {
+                for (uint8 i = 0; i < numRanges; ++i)
+                {
+                    if (level >= ranges[i].lower && level <= ranges[i].upper)
+                    {
+                        m_bracketByLevel[teamId][level] = i;
+                        break;
+                    }
+                }
+            }
+
+            for (uint8 group = 0; group < MAX_BRACKET_CLASS_GROUPS; ++group)
+            {
+                int16 targetRange = -1;
+                int smallestDiff = std::numeric_limits<int>::max();
+                for (uint8 i = 0; i < numRanges; ++i)
+                {
+                    if (ranges[i].lower > ranges[i].upper)
+                    {
+                        continue;
+                    }
+
+                    // Skip brackets that Death Knights cannot be assigned to (upper bound < 55)
+                    if (group == BRACKET_CLASS_GROUP_DEATH_KNIGHT && ranges[i].upper < 55)
+                    {
+                        continue;
+                    }
+
+                    int diff = 0;
+                    if (level < ranges[i].lower)
+                    {
+                        diff = ranges[i].lower - level;
+                    }
+                    else if (level > ranges[i].upper)
+                    {
+                        diff = level - ranges[i].upper;
+                    }
+                    if (diff < smallestDiff)
+                    {
+                        smallestDiff = diff;
+                        targetRange = i;
+                    }
+                }
+                m_nearestBracketByLevel[teamId][group][level] = targetRange;
+            }
+        }
+    }
+
+    /**
+     * @return int The bracket containing the level, or -1 if there is none.
+     */
+    int BracketOf(uint8 teamId, uint8 level) const
+    {
+        return teamId <= BRACKET_TEAM_HORDE ? m_bracketByLevel[teamId][level] : -1;
+    }
+
+    /**
+     * @return int The nearest bracket the class group may be assigned to, or -1 if there is none.
+     */
+    int NearestBracket(uint8 teamId, uint8 group, uint8 level) const
+    {
+        return (teamId <= BRACKET_TEAM_HORDE && group < MAX_BRACKET_CLASS_GROUPS) ? m_nearestBracketByLevel[teamId][group][level] : -1;
+    }
+
+private:
+    int16 m_bracketByLevel[2][BRACKET_LEVEL_SLOTS] = {};
+    int16 m_nearestBracketByLevel[2][MAX_BRACKET_CLASS_GROUPS][BRACKET_LEVEL_SLOTS] = {};
+};
+
+// -----------------------------------------------------------------------------
+// SURPLUS DEADBAND
+// -----------------------------------------------------------------------------
+// How far a bracket may run over its desired count before the rebalancer acts on it. A bracket
+// starts correcting once its surplus exceeds the tolerance and keeps correcting until the surplus
+// is back at the release threshold, so a bracket hovering around its target does not flip between
+// the two states every pass.
+struct BracketDeadband
+{
+    uint32 absolute = 0;    ///< Tolerated surplus in bots
+    float percent = 0.0f;   ///< Tolerated surplus as a percentage of the desired count
+    uint32 release = 0;     ///< Surplus a correcting bracket is brought back to
+
+    /**
+     * @brief Returns the surplus a bracket may carry before it starts correcting.
+     *
+     * @param desired The desired bot count of the bracket.
+     * @return int The larger of the absolute and the relative tolerance.
+     */
+    int Tolerance(int desired) const
+    {
+        int relative = static_cast<int>(percent / 100.0f * std::max(desired, 0) + 0.5f);
+        return std::max(static_cast<int>(absolute), relative);
+    }
+
+    /**
+     * @brief Returns how many surplus bots of a bracket the rebalancer should move.
+     *
+     * @param actual The current bot count of the bracket.
+     * @param desired The desired bot count of the bracket.
+     * @param correcting Whether the bracket was already correcting after the previous pass.
+     * @return int The surplus above the release threshold, or 0 while the bracket is within its deadband.
+     *         A positive value means the bracket is (still) correcting.
+     */
+    int ActionableSurplus(int actual, int desired, bool correcting) const
+    {
+        int tolerance = Tolerance(desired);
+        int releaseAt = std::min(static_cast<int>(release), tolerance);
+        int surplus = actual - desired;
+        if (surplus <= (correcting ? releaseAt : tolerance))
+        {
+            return 0;
+        }
+        return surplus - releaseAt;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// REAL PLAYER SMOOTHING
+// -----------------------------------------------------------------------------
+/**
+ * @class BracketCountSmoother
+ * @brief Exponential moving average of per-bracket counts, with a half-life in seconds.
+ *
+ * A sample taken t seconds after the previous one moves the average by 1 - 2^(-t / halfLife) of
+ * the way towards it, so the result does not depend on how often samples are taken.
+ */
+class BracketCountSmoother
+{
+public:
+    /**
+     * @brief Forgets the average; the next sample is taken as is.
+     */
+    void Reset()
+    {
+        m_values.clear();
+    }
+
+    /**
+     * @brief Folds a new sample into the average.
+     *
+     * @param counts The current count per bracket.
+     * @param nowSec Current time in seconds.
+     * @param halfLife Seconds for an old sample to lose half its weight; 0 disables smoothing.
+     * @return const std::vector<float>& The smoothed count per bracket.
+     */
+    const std::vector<float>& Update(const std::vector<int>& counts, uint32 nowSec, uint32 halfLife)
+    {
+        if (halfLife == 0 || m_values.size() != counts.size())
+        {
+            m_values.assign(counts.begin(), counts.end());
+        }
+        else if (nowSec > m_lastSampleSec)
+        {
+            float alpha = 1.0f - static_cast<float>(std::exp2(-double(nowSec - m_lastSampleSec) / halfLife));
+            for (size_t i = 0; i < counts.size(); ++i)
+            {
+                m_values[i] += alpha * (counts[i] - m_values[i]);
+            }
+        }
+        m_lastSampleSec = nowSec;
+        return m_values;
+    }
+
+private:
+    std::vector<float> m_values;
+    uint32 m_lastSampleSec = 0;
+};
+
+// -----------------------------------------------------------------------------
+// HOURLY PROFILES
+// -----------------------------------------------------------------------------
+static constexpr uint8 PROFILE_HOURS = 24;
+
+/**
+ * @class BracketHourlyProfile
+ * @brief Expected count per bracket for each hour of the day, learned from samples.
+ *
+ * Each hour keeps the mean of the samples taken during it. Once an hour holds more samples than the
+ * window, older samples fade out like in a moving average over that many samples, so the profile
+ * follows a slowly changing daily pattern.
+ */
+class BracketHourlyProfile
+{
+public:
+    /**
+     * @brief Clears the profile and sizes it for the given brackets.
+     */
+    void Reset(const std::vector<LevelRangeConfig>& ranges, uint8 numRanges)
+    {
+        m_bounds.assign(ranges.begin(), ranges.begin() + numRanges);
+        for (Hour& hour : m_hours)
+        {
+            hour.counts.assign(numRanges, 0.0f);
+            hour.samples = 0;
+        }
+    }
+
+    /**
+     * @brief Checks whether the profile was learned for brackets with these bounds.
+     */
+    bool Matches(const std::vector<LevelRangeConfig>& ranges, uint8 numRanges) const
+    {
+        if (m_bounds.size() != numRanges)
+        {
+            return false;
+        }
+        for (uint8 i = 0; i < numRanges; ++i)
+        {
+            if (m_bounds[i].lower != ranges[i].lower || m_bounds[i].upper != ranges[i].upper)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Folds a sample of the current counts into an hour.
+     *
+     * @param hour The hour of the day the sample was taken in.
+     * @param counts The count per bracket.
+     * @param window Number of samples the hour averages over once it has that many.
+     */
+    void AddSample(uint8 hour, const std::vector<int>& counts, uint32 window)
+    {
+        Hour& slot = m_hours[hour % PROFILE_HOURS];
+        if (counts.size() != slot.counts.size())
+        {
+            return;
+        }
+        ++slot.samples;
+        float weight = 1.0f / std::min(slot.samples, std::max<uint32>(window, 1));
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            slot.counts[i] += weight * (counts[i] - slot.counts[i]);
+        }
+    }
+
+    /**
+     * @brief Sets a learned value, e.g. one saved before a restart.
+     */
+    void Restore(uint8 hour, uint8 range, float count, uint32 samples)
+    {
+        Hour& slot = m_hours[hour % PROFILE_HOURS];
+        if (range < slot.counts.size())
+        {
+            slot.counts[range] = count;
+            slot.samples = std::max(slot.samples, samples);
+        }
+    }
+
+    uint32 GetSamples(uint8 hour) const { return m_hours[hour % PROFILE_HOURS].samples; }
+
+    const std::vector<float>& GetCounts(uint8 hour) const { return m_hours[hour % PROFILE_HOURS].counts; }
+
+    float GetTotal(uint8 hour) const
+    {
+        float total = 0.0f;
+        for (float count : GetCounts(hour))
+        {
+            total += count;
+        }
+        return total;
+    }
+
+private:
+    struct Hour
+    {
+        std::vector<float> counts;
+        uint32 samples = 0;
+    };
+
+    std::array<Hour, PROFILE_HOURS> m_hours;
+    std::vector<LevelRangeConfig> m_bounds;
+};
+
+
+/**
+ * @brief Finds the busy hour to position bots for while the current hour is quiet.
+ *
+ * An hour is busy when its expected total reaches quietPercent of the busiest learned hour.
+ *
+ * @param totals Expected total per hour of the day; negative for hours not learned yet.
+ * @param hour The current hour of the day.
+ * @param quietPercent Share of the busiest hour, in percent, below which an hour is quiet.
+ * @return int Hours until the next learned busy hour (1 to 23), or 0 if the current hour is busy or
+ *         not learned yet, or no busy hour is known.
+ */
+inline int GetHoursUntilBusy(const std::array<float, PROFILE_HOURS>& totals, uint8 hour, float quietPercent)
+{
+    float peak = *std::max_element(totals.begin(), totals.end());
+    if (peak <= 0.0f || totals[hour % PROFILE_HOURS] < 0.0f)
+    {
+        return 0;
+    }
+
+    float busyAt = quietPercent / 100.0f * peak;
+    if (totals[hour % PROFILE_HOURS] >= busyAt)
+    {
+        return 0;
+    }
+    for (int ahead = 1; ahead < PROFILE_HOURS; ++ahead)
+    {
+        if (totals[(hour + ahead) % PROFILE_HOURS] >= busyAt)
+        {
+            return ahead;
+        }
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// REBALANCING PLANNER
+// -----------------------------------------------------------------------------
+// Lowest level a Death Knight can be reset to.
+static constexpr uint8 DEATH_KNIGHT_MIN_LEVEL = 55;
+
+// A number of bots of one class group to move from one bracket to another.
+struct RebalanceMove
+{
+    uint8 from;
+    uint8 to;
+    uint8 group;
+    uint32 count;
+};
+
+
+/**
+ * @brief Returns the level range a bot of the given class group would be reset to within a bracket.
+ *
+ * @return false if the class group cannot be assigned to the bracket.
+ */
+inline bool GetAssignableRange(const LevelRangeConfig& range, uint8 group, uint8& lower, uint8& upper)
+{
+    lower = range.lower;
+    upper = range.upper;
+    if (group == BRACKET_CLASS_GROUP_DEATH_KNIGHT && lower < DEATH_KNIGHT_MIN_LEVEL)
+    {
+        lower = DEATH_KNIGHT_MIN_LEVEL;
+    }
+    return lower <= upper;
+}
+
+
+/**
+ * @brief Returns how many levels a bot is away from the nearest level it could be reset to in a bracket.
+ *
+ * @return int The distance, or std::numeric_limits<int>::max() if the class group cannot be assigned to the bracket.
+ */
+inline int GetLevelDistanceToRange(uint8 level, const LevelRangeConfig& range, uint8 group)
+{
+    uint8 lower;
+    uint8 upper;
+    if (!GetAssignableRange(range, group, lower, upper))
+    {
+        return std::numeric_limits<int>::max();
+    }
+    if (level < lower)
+    {
+        return lower - level;
+    }
+    return level > upper ? level - upper : 0;
+}
+
+
+/**
+ * @brief Draws a level for a new or re-rolled bot from the brackets that are short of bots.
+ *
+ * A bracket is picked with a probability proportional to its deficit, then a level uniformly within
+ * the part of it the class group may be assigned to.
+ *
+ * @param ranges The brackets of the faction.
+ * @param numRanges The number of brackets in use.
+ * @param actual Current bot count per bracket.
+ * @param desired Desired bot count per bracket.
+ * @param group The bot's class group (BracketClassGroup).
+ * @param rand Called as rand(lower, upper) for a uniform integer in [lower, upper].
+ * @return uint8 The level, or 0 if no bracket the group may join is short of bots.
+ */
+template <typename Rand>
+inline uint8 SampleDeficitLevel(const std::vector<LevelRangeConfig>& ranges, uint8 numRanges, const std::vector<int>& actual,
+    const std::vector<int>& desired, uint8 group, Rand&& rand)
+{
+    uint32 totalDeficit = 0;
+    for (uint8 i = 0; i < numRanges; ++i)
+    {
+        uint8 lower;
+        uint8 upper;
+        if (desired[i] > actual[i] && GetAssignableRange(ranges[i], group, lower, upper))
+        {
+            totalDeficit += desired[i] - actual[i];
+        }
+    }
+    if (totalDeficit == 0)
+    {
+        return 0;
+    }
+
+    uint32 pick = rand(0u, totalDeficit - 1);
+    for (uint8 i = 0; i < numRanges; ++i)
+    {
+        uint8 lower;
+        uint8 upper;
+        if (desired[i] <= actual[i] || !GetAssignableRange(ranges[i], group, lower, upper))
+        {
+            continue;
+        }
+        uint32 deficit = desired[i] - actual[i];
+        if (pick < deficit)
+        {
+            return static_cast<uint8>(rand(static_cast<uint32>(lower), static_cast<uint32>(upper)));
+        }
+        pick -= deficit;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Plans the bracket-to-bracket moves that bring a faction to its desired distribution.
+ *
+ * Solved as a small transportation problem with successive shortest paths: every surplus bracket
+ * supplies up to its surplus, split by class group so Death Knights only go to brackets that reach
+ * level 55, and every deficit bracket takes up to its deficit. A move costs the distance between
+ * the bracket centres in levels, so the plan uses the fewest resets possible (each one removes a
+ * surplus and fills a deficit) and, among those, prefers short moves between neighbouring brackets.
+ *
+ * @param ranges The brackets of the faction.
+ * @param numRanges The number of brackets in use.
+ * @param actual Bots per bracket.
+ * @param desired Desired bots per bracket.
+ * @param movable Bots per bracket and class group that may be moved.
+ * @return std::vector<RebalanceMove> The moves, with a non-zero count each.
+ */
+inline std::vector<RebalanceMove> PlanMinCostRebalance(const std::vector<LevelRangeConfig>& ranges, uint8 numRanges,
+    const std::vector<int>& actual, const std::vector<int>& desired,
+    const std::vector<std::array<uint32, MAX_BRACKET_CLASS_GROUPS>>& movable)
+{
+    struct Edge
+    {
+        int to;
+        int capacity;
+        int cost;
+        int reverse;
+    };
+
+    // Nodes: source, one per surplus bracket, one per surplus bracket and class group, one per deficit bracket, sink.
+    const int n = numRanges;
+    const int source = 0;
+    const int sink = 1 + n + n * MAX_BRACKET_CLASS_GROUPS + n;
+    auto bracketNode = [](int i) { return 1 + i; };
+    auto groupNode = [n](int i, int group) { return 1 + n + i * MAX_BRACKET_CLASS_GROUPS + group; };
+    auto targetNode = [n](int j) { return 1 + n + n * MAX_BRACKET_CLASS_GROUPS + j; };
+
+    std::vector<std::vector<Edge>> graph(sink + 1);
+    auto addEdge = [&graph](int from, int to, int capacity, int cost)
+    {
+        graph[from].push_back({ to, capacity, cost, static_cast<int>(graph[to].size()) });
+        graph[to].push_back({ from, 0, -cost, static_cast<int>(graph[from].size()) - 1 });
+    };
+
+    bool hasSurplus = false;
+    bool hasDeficit = false;
+    for (int i = 0; i < n; ++i)
+    {
+        if (actual[i] > desired[i])
+        {
+            hasSurplus = true;
+            addEdge(source, bracketNode(i), actual[i] - desired[i], 0);
+            for (uint8 group = 0; group < MAX_BRACKET_CLASS_GROUPS; ++group)
+            {
+                if (movable[i][group] > 0)
+                {
+                    addEdge(bracketNode(i), groupNode(i, group), static_cast<int>(movable[i][group]), 0);
+                }
+            }
+        }
+        else if (actual[i] < desired[i])
+        {
+            hasDeficit = true;
+            addEdge(targetNode(i), sink, desired[i] - actual[i], 0);
+        }
+    }
+    if (!hasSurplus || !hasDeficit)
+    {
+        return {};
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (actual[i] <= desired[i])
+        {
+            continue;
+        }
+        int fromCentre = ranges[i].lower + ranges[i].upper;
+        for (uint8 group = 0; group < MAX_BRACKET_CLASS_GROUPS; ++group)
+        {
+            if (movable[i][group] == 0)
+            {
+                continue;
+            }
+            for (int j = 0; j < n; ++j)
+            {
+                uint8 lower;
+                uint8 upper;
+                if (actual[j] >= desired[j] || !GetAssignableRange(ranges[j], group, lower, upper))
+                {
+                    continue;
+                }
+                // Centres are kept doubled to stay integral.
+                int toCentre = lower + upper;
+                addEdge(groupNode(i, group), targetNode(j), std::numeric_limits<int>::max() / 2, std::abs(fromCentre - toCentre));
+            }
+        }
+    }
+
+    // Successive shortest paths; Bellman-Ford copes with the negative costs of the residual edges.
+    const int unreachable = std::numeric_limits<int>::max();
+    std::vector<int> distance(graph.size());
+    std::vector<int> previousNode(graph.size());
+    std::vector<int> previousEdge(graph.size());
+    while (true)
+    {
+        std::fill(distance.begin(), distance.end(), unreachable);
+        distance[source] = 0;
+        bool updated = true;
+        for (size_t round = 0; round < graph.size() && updated; ++round)
+        {
+            updated = false;
+            for (size_t node = 0; node < graph.size(); ++node)
+            {
+                if (distance[node] == unreachable)
+                {
+                    continue;
+                }
+                for (size_t e = 0; e < graph[node].size(); ++e)
+                {
+                    const Edge& edge = graph[node][e];
+                    if (edge.capacity > 0 && distance[node] + edge.cost < distance[edge.to])
+                    {
+                        distance[edge.to] = distance[node] + edge.cost;
+                        previousNode[edge.to] = static_cast<int>(node);
+                        previousEdge[edge.to] = static_cast<int>(e);
+                        updated = true;
+                    }
+                }
+            }
+        }
+        if (distance[sink] == unreachable)
+        {
+            break;
+        }
+
+        int flow = std::numeric_limits<int>::max();
+        for (int node = sink; node != source; node = previousNode[node])
+        {
+            flow = std::min(flow, graph[previousNode[node]][previousEdge[node]].capacity);
+        }
+        for (int node = sink; node != source; node = previousNode[node])
+        {
+            Edge& edge = graph[previousNode[node]][previousEdge[node]];
+            edge.capacity -= flow;
+            graph[node][edge.reverse].capacity += flow;
+        }
+    }
+
+    // The flow on each group-to-target edge is the capacity gained by its reverse edge.
+    std::vector<RebalanceMove> moves;
+    for (int i = 0; i < n; ++i)
+    {
+        for (uint8 group = 0; group < MAX_BRACKET_CLASS_GROUPS; ++group)
+        {
+            if (actual[i] <= desired[i] || movable[i][group] == 0)
+            {
+                continue;
+            }
+            for (const Edge& edge : graph[groupNode(i, group)])
+            {
+                if (edge.to < targetNode(0) || edge.to > targetNode(n - 1))
+                {
+                    continue;
+                }
+                int flow = graph[edge.to][edge.reverse].capacity;
+                if (flow > 0)
+                {
+                    moves.push_back({ static_cast<uint8>(i), static_cast<uint8>(edge.to - targetNode(0)), group, static_cast<uint32>(flow) });
+                }
+            }
+        }
+    }
+    return moves;
+}
+
+// -----------------------------------------------------------------------------
+// RESET RATE LIMIT
+// -----------------------------------------------------------------------------
+/**
+ * @class ResetTokenBucket
+ * @brief Token bucket capping how many level resets may run over time.
+ *
+ * The bucket refills at a steady rate up to its burst size, and each reset takes one token. A
+ * bucket configured with a rate of 0 is unlimited.
+ */
+class ResetTokenBucket
+{
+public:
+    /**
+     * @brief Sets the refill rate and burst size.
+     *
+     * The first call fills the bucket. Later calls keep the tokens already collected, capped at the
+     * new burst size, so a configuration reload does not hand out a fresh burst.
+     *
+     * @param perHour Tokens added per hour, 0 for no limit.
+     * @param burst Maximum number of tokens held; at least one.
+     * @param nowMs Current time in milliseconds.
+     */
+    void Configure(uint32 perHour, uint32 burst, uint64 nowMs)
+    {
+        m_tokensPerMs = perHour / 3600000.0;
+        m_capacity = std::max<uint32>(burst, 1);
+        m_tokens = m_configured ? std::min(m_tokens, m_capacity) : m_capacity;
+        m_lastRefillMs = nowMs;
+        m_configured = true;
+    }
+
+    bool IsUnlimited() const { return m_tokensPerMs <= 0.0; }
+
+    /**
+     * @brief Adds the tokens earned since the previous refill.
+     *
+     * @param nowMs Current time in milliseconds.
+     */
+    void Refill(uint64 nowMs)
+    {
+        if (nowMs > m_lastRefillMs)
+        {
+            m_tokens = std::min(m_capacity, m_tokens + (nowMs - m_lastRefillMs) * m_tokensPerMs);
+        }
+        m_lastRefillMs = nowMs;
+    }
+
+    bool HasToken() const { return IsUnlimited() || m_tokens >= 1.0; }
+
+    void TakeToken()
+    {
+        if (!IsUnlimited())
+        {
+            m_tokens = std::max(0.0, m_tokens - 1.0);
+        }
+    }
+
+    double GetTokens() const { return m_tokens; }
+
+private:
+    double m_tokensPerMs = 0.0;
+    double m_capacity = 1.0;
+    double m_tokens = 1.0;
+    uint64 m_lastRefillMs = 0;
+    bool m_configured = false;
+};
+
+// -----------------------------------------------------------------------------
+// PENDING LEVEL RESETS
+// -----------------------------------------------------------------------------
+template <typename Guid>
+struct BasicPendingResetEntry
+{
+    Guid botGuid;
+    int targetRange;
+    const LevelRangeConfig* factionRanges;
+    uint8 teamId = BRACKET_TEAM_ALLIANCE;
+    uint32 enqueuedAt = 0;  ///< Game time (seconds) when the bot was first flagged
+    uint64 sequence = 0;    ///< Enqueue order, used to break priority ties by age
+    uint8 heldReason = 0xFF;///< Why the bot was last held back (a BracketTraceReason), 0xFF = never
+    bool urgent = false;    ///< Reset on the next tick, ahead of every other entry (e.g. assigned at login)
+    int fromRange = -1;     ///< Bracket the bot was in when an urgent entry was queued, -1 = outside every bracket
+};
+
+/**
+ * @class BasicPendingResetQueue
+ * @brief Bots waiting for a level reset, keyed by GUID.
+ *
+ * Lookups, duplicate checks and removals are O(1). The processing order is built on demand by
+ * BuildProcessingOrder(): urgent entries first, then biggest deficit of the target bracket, then
+ * oldest entry first, alternating between Alliance and Horde so a per-cycle limit cannot starve
+ * either faction.
+ *
+ * @tparam Guid The bot GUID type; needs std::hash and equality.
+ * @tparam Clock Provides static uint32 Now(), the time stamped on new entries.
+ */
+template <typename Guid, typename Clock>
+class BasicPendingResetQueue
+{
+public:
+    using Entry = BasicPendingResetEntry<Guid>;
+
+    bool Contains(Guid guid) const
+    {
+        return m_entries.count(guid) > 0;
+    }
+
+    const Entry* Find(Guid guid) const
+    {
+        auto itr = m_entries.find(guid);
+        return itr != m_entries.end() ? &itr->second : nullptr;
+    }
+
+    /**
+     * @brief Queues a bot unless it is already queued.
+     *
+     * Entries keep their original age when moved between queues. New entries that already carry an
+     * enqueuedAt, such as ones restored from the database, keep that time.
+     *
+     * @return true if the bot was added, false if it was already queued.
+     */
+    bool Push(Entry entry)
+    {
+        if (entry.sequence == 0)
+        {
+            entry.sequence = ++s_lastSequence;
+            if (entry.enqueuedAt == 0)
+            {
+                entry.enqueuedAt = Clock::Now();
+            }
+        }
+        if (!m_entries.emplace(entry.botGuid, entry).second)
+        {
+            return false;
+        }
+        if (entry.urgent)
+        {
+            ++m_urgentCount;
+        }
+        return true;
+    }
+
+    bool Remove(Guid guid)
+    {
+        auto itr = m_entries.find(guid);
+        if (itr == m_entries.end())
+        {
+            return false;
+        }
+        if (itr->second.urgent)
+        {
+            --m_urgentCount;
+        }
+        m_entries.erase(itr);
+        return true;
+    }
+
+    /**
+     * @brief Records why a queued bot is held back.
+     *
+     * @return true if the reason differs from the one recorded last, i.e. the hold is news.
+     */
+    bool MarkHeld(Guid guid, uint8 reason)
+    {
+        auto itr = m_entries.find(guid);
+        if (itr == m_entries.end() || itr->second.heldReason == reason)
+        {
+            return false;
+        }
+        itr->second.heldReason = reason;
+        return true;
+    }
+
+    void Clear()
+    {
+        m_entries.clear();
+        m_urgentCount = 0;
+    }
+
+    bool Empty() const
+    {
+        return m_entries.empty();
+    }
+
+    size_t Size() const
+    {
+        return m_entries.size();
+    }
+
+    size_t UrgentCount() const
+    {
+        return m_urgentCount;
+    }
+
+    const std::unordered_map<Guid, Entry>& Entries() const
+    {
+        return m_entries;
+    }
+
+    /**
+     * @brief Returns the queued GUIDs in processing order.
+     *
+     * @param deficits Bots missing per bracket, indexed by TeamId and then by bracket index.
+     *                 Brackets without a deficit may hold zero or negative values.
+     * @param urgentOnly Leave out the entries that are not urgent.
+     * @return std::vector<Guid> The urgent entries of both factions, then the others. Within each
+     *         part Alliance and Horde entries are interleaved, each faction sorted by descending
+     *         target deficit and then by age.
+     */
+    std::vector<Guid> BuildProcessingOrder(const std::vector<int> (&deficits)[2], bool urgentOnly = false)
+    {
+        std::vector<const Entry*> byTeam[2];
+        for (const auto& itr : m_entries)
+        {
+            if (urgentOnly && !itr.second.urgent)
+            {
+                continue;
+            }
+            byTeam[itr.second.teamId == BRACKET_TEAM_HORDE ? BRACKET_TEAM_HORDE : BRACKET_TEAM_ALLIANCE].push_back(&itr.second);
+        }
+
+        auto deficitOf = [&deficits](const Entry* entry)
+        {
+            const std::vector<int>& teamDeficits = deficits[entry->teamId == BRACKET_TEAM_HORDE ? BRACKET_TEAM_HORDE : BRACKET_TEAM_ALLIANCE];
+            if (entry->targetRange < 0 || static_cast<size_t>(entry->targetRange) >= teamDeficits.size())
+            {
+                return 0;
+            }
+            return teamDeficits[entry->targetRange];
+        };
+        for (auto& entries : byTeam)
+        {
+            std::sort(entries.begin(), entries.end(), [&deficitOf](const Entry* a, const Entry* b)
+            {
+                if (a->urgent != b->urgent)
+                {
+                    return a->urgent;
+                }
+                int deficitA = deficitOf(a);
+                int deficitB = deficitOf(b);
+                if (deficitA != deficitB)
+                {
+                    return deficitA > deficitB;
+                }
+                return a->sequence < b->sequence;
+            });
+        }
+
+        // Alternate which faction goes first so a limit of one reset per cycle is fair too.
+        uint8 first = m_hordeFirst ? BRACKET_TEAM_HORDE : BRACKET_TEAM_ALLIANCE;
+        uint8 second = m_hordeFirst ? BRACKET_TEAM_ALLIANCE : BRACKET_TEAM_HORDE;
+        m_hordeFirst = !m_hordeFirst;
+
+        // Each faction's list starts with its urgent entries; interleave those, then the rest.
+        auto urgentEnd = [](const std::vector<const Entry*>& entries)
+        {
+            return static_cast<size_t>(std::find_if(entries.begin(), entries.end(), [](const Entry* entry) { return !entry->urgent; }) - entries.begin());
+        };
+        size_t begin[2] = { 0, 0 };
+        size_t end[2] = { urgentEnd(byTeam[0]), urgentEnd(byTeam[1]) };
+
+        std::vector<Guid> order;
+        order.reserve(byTeam[0].size() + byTeam[1].size());
+        for (int part = 0; part < 2; ++part)
+        {
+            for (size_t i = 0; begin[first] + i < end[first] || begin[second] + i < end[second]; ++i)
+            {
+                if (begin[first] + i < end[first])
+                {
+                    order.push_back(byTeam[first][begin[first] + i]->botGuid);
+                }
+                if (begin[second] + i < end[second])
+                {
+                    order.push_back(byTeam[second][begin[second] + i]->botGuid);
+                }
+            }
+            for (int team = 0; team < 2; ++team)
+            {
+                begin[team] = end[team];
+                end[team] = byTeam[team].size();
+            }
+        }
+        return order;
+    }
+
+private:
+    std::unordered_map<Guid, Entry> m_entries;
+    size_t m_urgentCount = 0;
+    bool m_hordeFirst = false;
+    static inline uint64 s_lastSequence = 0;
+};
+
+// -----------------------------------------------------------------------------
+// DECISION TRACE
+// -----------------------------------------------------------------------------
+// What the module decided about a bot. Stored in BracketTraceRecord::reason.
+enum BracketTraceReason : uint8
+{
+    BRACKET_TRACE_FLAGGED_OUT_OF_RANGE = 0, ///< Level outside every bracket, flagged for the nearest one
+    BRACKET_TRACE_FLAGGED_SURPLUS,          ///< Picked by the planner to leave a surplus bracket
+    BRACKET_TRACE_NOT_SAFE,                 ///< Pending reset put off because the bot is busy
+    BRACKET_TRACE_RATE_LIMITED,             ///< Pending reset put off because a reset quota is empty
+    BRACKET_TRACE_RESET,                    ///< Level reset carried out, or its first stage with staged resets
+    BRACKET_TRACE_DROPPED_OFFLINE,          ///< Pending reset dropped because the bot left the world
+    BRACKET_TRACE_DROPPED_EXCLUDED,         ///< Pending reset dropped because the bot became excluded
+    BRACKET_TRACE_STAGED_CANCELLED,         ///< Reset in progress abandoned because the bot logged out or left the world
+    BRACKET_TRACE_ASSIGNED_AT_LOGIN,        ///< Given a new bracket as it logged in
+    MAX_BRACKET_TRACE_REASONS
+};
+
+/**
+ * @brief Returns a short name for a trace reason, for dumps.
+ */
+inline const char* GetBracketTraceReasonName(uint8 reason)
+{
+    static const char* const names[MAX_BRACKET_TRACE_REASONS] =
+    {
+        "flagged-out-of-range",
+        "flagged-surplus",
+        "not-safe",
+        "rate-limited",
+        "reset",
+        "dropped-offline",
+        "dropped-excluded",
+        "staged-cancelled",
+        "assigned-at-login"
+    };
+    return reason < MAX_BRACKET_TRACE_REASONS ? names[reason] : "unknown";
+}
+
+// One decision about one bot. Brackets are 0-based, -1 when not applicable.
+struct BracketTraceRecord
+{
+    uint64 timeMs;  ///< Game time of the decision
+    uint32 guid;    ///< Bot GUID counter
+    int16 fromRange;
+    int16 toRange;
+    uint8 reason;   ///< BracketTraceReason
+    uint8 teamId;
+};
+
+/**
+ * @class BracketTraceRing
+ * @brief Fixed-size ring buffer holding the most recent decision records.
+ *
+ * Push() is a copy and an index bump with no allocation and no lock, so the trace can stay on all
+ * the time; the oldest records are overwritten once the ring is full. There is a single writer
+ * (the world thread). The write index is atomic so a reader on the same thread, or one that
+ * tolerates the record being overwritten under it, always sees a valid range.
+ *
+ * @tparam Capacity Number of records kept; must be a power of two.
+ */
+template <size_t Capacity>
+class BracketTraceRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    void Push(const BracketTraceRecord& record)
+    {
+        uint64 index = m_next.load(std::memory_order_relaxed);
+        m_records[index & (Capacity - 1)] = record;
+        m_next.store(index + 1, std::memory_order_release);
+    }
+
+    /// Records pushed since startup, including the ones already overwritten.
+    uint64 GetTotal() const
+    {
+        return m_next.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Calls fn on up to count of the most recent records, oldest first.
+     *
+     * @param count Maximum number of records to visit; 0 visits every record still held.
+     * @param fn Called as fn(const BracketTraceRecord&).
+     */
+    template <typename Fn>
+    void ForEachRecent(size_t count, Fn&& fn) const
+    {
+        uint64 end = m_next.load(std::memory_order_acquire);
+        uint64 held = std::min<uint64>(end, Capacity);
+        if (count > 0 && count < held)
+        {
+            held = count;
+        }
+        for (uint64 index = end - held; index < end; ++index)
+        {
+            fn(m_records[index & (Capacity - 1)]);
+        }
+    }
+
+private:
+    std::array<BracketTraceRecord, Capacity> m_records = {};
+    std::atomic<uint64> m_next{ 0 };
+};
+
+#endif // MOD_BOT_LEVEL_BRACKETS_CORE_H
@@ -0,0 +1,128 @@
+#ifndef MOD_BOT_LEVEL_BRACKETS_STATS_H
+#define MOD_BOT_LEVEL_BRACKETS_STATS_H
+
+// Layout of the stats segment the Bot Level Brackets module publishes to the file named by
+// BotLevelBrackets.StatsFile. The file is a memory-mapped, fixed-size BracketStatsSegment that the
+// world thread rewrites once per pending reset cycle. External collectors map the same file
+// read-only and copy the payload with ReadBracketStatsSegment(); neither side ever blocks the other.
+//
+// This header only uses the standard library so collectors can include it without AzerothCore.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// "BLBS", stored in BracketStatsSegment::magic.
+static constexpr std::uint32_t BRACKET_STATS_MAGIC = 0x53424C42;
+// Bumped whenever the layout of BracketStatsPayload changes.
+static constexpr std::uint32_t BRACKET_STATS_VERSION = 1;
+// One slot per possible bracket (BotLevelBrackets.NumRanges is at most 255).
+static constexpr std::uint32_t BRACKET_STATS_MAX_RANGES = 256;
+
+// Per-phase timings, in microseconds, of the most recent run of each phase.
+enum BracketStatsPhase : std::uint32_t
+{
+    BRACKET_STATS_PHASE_COLLECT = 0,    ///< Collecting bots into brackets (all slices of the last pass)
+    BRACKET_STATS_PHASE_PLAN_ALLIANCE,  ///< Planning the Alliance redistribution
+    BRACKET_STATS_PHASE_PLAN_HORDE,     ///< Planning the Horde redistribution
+    BRACKET_STATS_PHASE_PENDING_RESETS, ///< One pending level reset cycle
+    BRACKET_STATS_PHASE_STAGED_RESETS,  ///< One tick of staged reset stages
+    MAX_BRACKET_STATS_PHASES
+};
+
+struct BracketStatsFaction
+{
+    std::uint32_t totalBots;                            ///< Random bots online, from the census
+    std::uint32_t pendingResets;                        ///< Bots of this faction waiting for a level reset
+    std::uint32_t oldestPendingAgeSec;                  ///< Age of the oldest pending reset, 0 when none
+    std::uint32_t reserved;
+    std::int32_t actual[BRACKET_STATS_MAX_RANGES];      ///< Random bots per bracket
+    std::int32_t desired[BRACKET_STATS_MAX_RANGES];     ///< Desired random bots per bracket
+};
+
+struct BracketStatsPayload
+{
+    std::uint64_t publishedAtMs;                        ///< Server game time of this snapshot
+    std::uint32_t enabled;                              ///< BotLevelBrackets.Enabled
+    std::uint32_t numRanges;                            ///< Brackets in use per faction
+    BracketStatsFaction factions[2];                    ///< Indexed by TeamId (0 = Alliance, 1 = Horde)
+    std::uint64_t resetsDone;                           ///< Level resets since startup
+    std::uint64_t resetsDropped;                        ///< Flagged bots dropped without a reset
+    std::uint64_t resetsRateLimited;                    ///< Reset cycles held back by the rate limit
+    double resetsPerHour;                               ///< Reset rate since the previous snapshot
+    std::uint64_t scansStarted;                         ///< Distribution passes started
+    std::uint64_t scansCompleted;                       ///< Distribution passes completed
+    std::uint64_t scansSkipped;                         ///< Distribution checks skipped by the census
+    std::uint32_t stagedResetsInProgress;               ///< Bots in the middle of a staged reset
+    std::uint32_t lastScanBots;                         ///< Bots collected by the last completed pass
+    std::uint32_t lastScanFlagged;                      ///< Bots flagged by the last completed pass
+    std::uint32_t lastScanWallMs;                       ///< Start to commit of the last completed pass
+    std::uint64_t phaseMicros[MAX_BRACKET_STATS_PHASES]; ///< See BracketStatsPhase
+};
+
+/**
+ * @brief The mapped file: a fixed header, a seqlock counter and the payload.
+ *
+ * The writer makes the sequence odd, copies the payload in and makes it even again. A reader that
+ * sees an odd sequence, or a different sequence after copying, retries.
+ */
+struct BracketStatsSegment
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t size;                                 ///< sizeof(BracketStatsSegment) of the writer
+    std::atomic<std::uint32_t> sequence;
+    BracketStatsPayload payload;
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "The seqlock counter is shared between processes");
+
+/**
+ * @brief Publishes a new payload into a mapped segment. Only one writer may exist.
+ *
+ * @param segment The mapped segment.
+ * @param payload The snapshot to publish.
+ */
+inline void WriteBracketStatsSegment(BracketStatsSegment& segment, const BracketStatsPayload& payload)
+{
+    std::uint32_t sequence = segment.sequence.load(std::memory_order_relaxed);
+    segment.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&segment.payload, &payload, sizeof(payload));
+    segment.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Copies a consistent payload out of a mapped segment.
+ *
+ * @param segment The mapped segment.
+ * @param payload Receives the snapshot.
+ * @param maxAttempts How many times to retry while the writer is mid-update.
+ * @return true if a consistent snapshot was copied, false if the header does not match this layout
+ *         or every attempt raced with the writer.
+ */
+inline bool ReadBracketStatsSegment(const BracketStatsSegment& segment, BracketStatsPayload& payload, int maxAttempts = 64)
+{
+    if (segment.magic != BRACKET_STATS_MAGIC || segment.version != BRACKET_STATS_VERSION || segment.size != sizeof(BracketStatsSegment))
+    {
+        return false;
+    }
+
+    for (int attempt = 0; attempt < maxAttempts; ++attempt)
+    {
+        std::uint32_t before = segment.sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            continue;
+        }
+        std::memcpy(&payload, &segment.payload, sizeof(payload));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment.sequence.load(std::memory_order_relaxed) == before)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // MOD_BOT_LEVEL_BRACKETS_STATS_H
@@ -1,4 +1,7 @@
 #include "ScriptMgr.h"
+#include "mod-player-bot-level-brackets.h"
+#include "mod-player-bot-level-brackets-core.h"
+#include "mod-player-bot-level-brackets-stats.h"
 #include "Player.h"
 #include "ObjectMgr.h"
 #include "Chat.h"
@@ -15,13 +18,37 @@
 #include <utility>
 #include <limits>
 #include <algorithm>
+#include <array>
+#include <deque>
+#include <chrono>
+#include <cstring>
+#include <new>
 #include "PlayerbotFactory.h"
 #include "DatabaseEnv.h"
 #include "QueryResult.h"
+#include "QueryCallback.h"
+#include "AsyncCallbackProcessor.h"
 #include <string>
+#include <sstream>
 #include "Player.h"
 #include "PlayerbotAIConfig.h"
 #include "ArenaTeamMgr.h"
+#include "Timer.h"
+#include "GameTime.h"
+#include "Map.h"
+#include "GroupMgr.h"
+#include "WorldPacket.h"
+#include "WorldSession.h"
+#include "WorldSessionMgr.h"
+#include "CharacterCache.h"
+#include "StringFormat.h"
+#include <mutex>
+#include <atomic>
+#if AC_PLATFORM != AC_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace Acore::ChatCommands;
 
@@ -30,17 +57,15 @@ class Guild;
 static bool IsAlliancePlayerBot(Player* bot);
 static bool IsHordePlayerBot(Player* bot);
 static void ClampAndBalanceBrackets();
+static void AbortDistributionScan();
+static bool IsBotIdleForLevelReset(Player* bot);
+static bool IsBotSafeForLevelReset(Player* bot);
+static void MarkBotForLoadoutRefresh(ObjectGuid::LowType guid);
 
 // -----------------------------------------------------------------------------
 // LEVEL RANGE CONFIGURATION
 // -----------------------------------------------------------------------------
-// Same boundaries for both factions; only desired percentages differ.
-struct LevelRangeConfig
-{
-    uint8 lower;         ///< Lower bound (inclusive)
-    uint8 upper;         ///< Upper bound (inclusive)
-    uint8 desiredPercent;///< Desired percentage of bots in this range
-};
+static_assert(BRACKET_TEAM_ALLIANCE == TEAM_ALLIANCE && BRACKET_TEAM_HORDE == TEAM_HORDE, "Bracket faction indices must match TeamId");
 
 // Instead of a fixed constant, load the number of brackets from configuration.
 static uint8 g_NumRanges = 9;
@@ -68,20 +93,73 @@ static bool   g_BotDistLiteDebugMode      = false;
 static bool   g_UseDynamicDistribution  = false;
 static bool   g_IgnoreFriendListed = true;
 static uint32 g_FlaggedProcessLimit = 5; // 0 = unlimited
+static uint32 g_FlaggedProcessBudgetMs = 0; // 0 = use g_FlaggedProcessLimit instead
+static uint32 g_ScanSliceSize = 0; // bots per tick, 0 = whole scan in one tick
+static uint32 g_ScanSliceBudgetMs = 0; // milliseconds per tick, 0 = no time budget
+static bool   g_StagedResets = false; // spread each level reset over several ticks
+static uint32 g_StagedResetStagesPerTick = 4; // reset stages run per tick, 0 = unlimited
+static BracketDeadband g_SurplusDeadband; // surplus tolerated per bracket before bots are moved out
+static uint32 g_ResetRatePerHour = 0; // level resets per hour over both factions, 0 = unlimited
+static uint32 g_ResetRateBurst = 20;
+static uint32 g_FactionResetRatePerHour = 0; // level resets per hour per faction, 0 = unlimited
+static uint32 g_FactionResetRateBurst = 10;
+static std::string g_StatsFile; // memory-mapped stats segment for external collectors, empty = disabled
+static bool   g_TraceDumpOnShutdown = true; // write the decision trace to the log on shutdown
+static uint32 g_PersistFrequency = 300; // in seconds, 0 = pending resets and census are not persisted
+static uint32 g_RestoreGracePeriod = 600; // in seconds, how long restored resets wait for their bots to log in
+static bool   g_LoginBracketAssignment = false; // pick a random bot's bracket as it logs in
+static bool   g_SampleNewBotLevels = false; // send never played random bots to a bracket drawn by BotLevelBracketsSampleLevel()
+static bool   g_OfflineRebalance = false; // also move offline random bots between brackets through the database
+static uint32 g_OfflineRebalanceFrequency = 3600; // in seconds
+static uint32 g_OfflineRebalanceMaxBots = 200; // offline bots moved per run, 0 = unlimited
+static bool   g_MapThreadResets = false; // run level resets on the map update thread that owns the bot
+static uint32 g_MapThreadResetsPerUpdate = 1; // level resets per map update, 0 = unlimited
 
 // Real player weight to boost bracket contributions.
 static float g_RealPlayerWeight = 1.0f;
+// Half-life, in seconds, of the moving average of real players per bracket. 0 = latest count only.
+static uint32 g_RealPlayerHalfLife = 0;
+// Moving average of real players per bracket, indexed by TeamId.
+static BracketCountSmoother g_RealPlayerCounts[2];
+// Learn when real players play which brackets, and position bots for busy hours during quiet ones.
+static bool g_ProfileEnabled = false;
+static uint32 g_ProfileMemoryDays = 7; // days of history each hour of the profile averages over
+static float g_ProfileQuietPercent = 50.0f; // hours below this share of the busiest hour are quiet
+// Real players per bracket for each hour of the day, indexed by TeamId.
+static BracketHourlyProfile g_HourlyProfiles[2];
 
 // If true, synchronize bracket logic and real player influence across both factions.
 // This option requires both Alliance and Horde bracket definitions to match perfectly.
 // When enabled, all real players (regardless of faction) affect the dynamic distribution for both factions.
 static bool g_SyncFactions = false;
 
-// Array for character social list friends
-std::vector<uint64> g_SocialFriendsList;
+// Friend index: number of friendships pointing at each character, keyed by GUID counter.
+static std::unordered_map<ObjectGuid::LowType, uint32> g_SocialFriendRefs;
+// Known (owner, friend) pairs, so repeated add/remove events cannot skew the reference counts.
+static std::unordered_set<uint64> g_SocialFriendPairs;
+
+// Friend list changes seen by the network threads, applied to the index on the world thread.
+struct SocialFriendEvent
+{
+    bool added;
+    uint32 ownerAccountId;   ///< The owner is looked up on the world thread, through its session
+    ObjectGuid friendGuid;   ///< Set for removals
+    std::string friendName;  ///< Set for additions, resolved on the world thread
+};
+static std::mutex g_SocialFriendEventsLock;
+static std::vector<SocialFriendEvent> g_SocialFriendEvents;
+// True while an asynchronous reload of the friend index is in flight.
+static bool g_SocialFriendListLoading = false;
+
+// Callbacks of the module's asynchronous database queries, run from the world thread.
+static QueryCallbackProcessor g_QueryProcessor;
+// Completion callbacks of the module's asynchronous transactions, run from the world thread.
+static AsyncCallbackProcessor<TransactionCallback> g_TransactionProcessor;
 
-// Array for excluded bot names.
-static std::vector<std::string> g_ExcludeBotNames;
+// Excluded bots from BotLevelBrackets.ExcludeNames, resolved to GUID counters.
+static std::unordered_set<ObjectGuid::LowType> g_ExcludeBotGuids;
+// Excluded names (normalized) with no matching character yet; resolved when such a character logs in.
+static std::unordered_set<std::string> g_ExcludeBotNames;
 
 // Array for real player guild IDs.
 std::unordered_set<uint32> g_RealPlayerGuildIds;
@@ -89,13 +167,382 @@ std::unordered_set<uint32> g_RealPlayerGuildIds;
 // Persistent guild tracker - stores guild IDs that have real players (from database)
 std::unordered_set<uint32> g_PersistentRealPlayerGuildIds;
 
-struct PendingResetEntry
+// Rows per multi-row statement when writing the persistent guild tracker.
+static constexpr size_t GUILD_TRACKER_BATCH_ROWS = 500;
+
+// Stamps pending reset entries with the game time.
+struct PendingResetGameClock
 {
-    ObjectGuid botGuid;
-    int targetRange;
-    const LevelRangeConfig* factionRanges;
+    static uint32 Now()
+    {
+        return static_cast<uint32>(GameTime::GetGameTime().count());
+    }
+};
+
+using PendingResetEntry = BasicPendingResetEntry<ObjectGuid>;
+using PendingResetQueue = BasicPendingResetQueue<ObjectGuid, PendingResetGameClock>;
+
+static PendingResetQueue g_PendingLevelResets;
+
+// Until this game time, pending resets whose bot is offline are kept instead of dropped, so resets
+// restored at startup survive until their bots log back in.
+static uint32 g_RestoreGraceUntil = 0;
+// Random bots per faction in the census saved before the last shutdown, while the live census is
+// still catching up with it. Cleared once the live census has caught up.
+static uint32 g_RestoredCensusTotal[2] = { 0, 0 };
+static bool g_RestoredCensusPending = false;
+// The saved census per faction and bracket, or empty when the brackets changed since it was saved.
+static std::vector<int> g_RestoredCensusCounts[2];
+
+// Moving average of the wall-clock cost of one AdjustBotToRange call, in milliseconds.
+static double g_ResetCostEstimateMs = 0.0;
+
+// Level reset quotas: one over both factions and one per faction, indexed by TeamId.
+static ResetTokenBucket g_ResetRateLimit;
+static ResetTokenBucket g_FactionResetRateLimit[2];
+
+// -----------------------------------------------------------------------------
+// MODULE STATISTICS
+// -----------------------------------------------------------------------------
+// Counters shown by ".bracket stats". Each one is a plain increment or store on the world thread.
+struct BotLevelBracketsStats
+{
+    uint64 resetsDone = 0;          ///< Level resets carried out (or started, with staged resets)
+    uint64 resetsDropped = 0;       ///< Flagged bots removed from the queue without a reset
+    uint64 resetsRateLimited = 0;   ///< Pending reset cycles that left bots queued because a reset quota was empty
+    uint64 scansStarted = 0;        ///< Distribution passes started
+    uint64 scansCompleted = 0;      ///< Distribution passes that reached the commit step
+    uint64 scansSkipped = 0;        ///< Distribution checks skipped because the census showed no imbalance
+    uint32 scanStartMSTime = 0;     ///< getMSTime() when the current pass started
+    uint32 scanWorkMs = 0;          ///< Time spent in the current pass so far
+    uint32 lastScanWorkMs = 0;      ///< Time spent in the last completed pass, over all its ticks
+    uint32 lastScanWallMs = 0;      ///< Time from start to commit of the last completed pass
+    uint32 lastScanBots = 0;        ///< Random bots collected by the last completed pass
+    uint32 lastScanFlagged = 0;     ///< Bots flagged by the last completed pass
+    uint32 lastScanFinishedAt = 0;  ///< Game time (seconds) when the last pass completed
+    uint64 scanCollectMicros = 0;   ///< Time spent collecting in the current pass so far
+    uint64 phaseMicros[MAX_BRACKET_STATS_PHASES] = {}; ///< Last run of each phase, see BracketStatsPhase
+};
+
+static BotLevelBracketsStats g_Stats;
+
+// The mapped stats segment and the file it is mapped from, while BotLevelBrackets.StatsFile is set.
+static BracketStatsSegment* g_StatsSegment = nullptr;
+static std::string g_StatsSegmentPath;
+// resetsDone and game time of the previous publish, to derive the reset rate.
+static uint64 g_StatsPublishedResets = 0;
+static uint64 g_StatsPublishedAtMs = 0;
+
+
+// The most recent decisions about individual bots, always recorded. See ".bracket trace".
+static constexpr size_t DECISION_TRACE_CAPACITY = 8192;
+static BracketTraceRing<DECISION_TRACE_CAPACITY> g_DecisionTrace;
+
+
+/**
+ * @brief Records a decision about a bot in the decision trace.
+ *
+ * @param guid The bot.
+ * @param teamId The bot's faction.
+ * @param reason What was decided.
+ * @param fromRange The bot's bracket at the time, or -1.
+ * @param toRange The bracket the bot is headed for, or -1.
+ */
+static void TraceBotDecision(ObjectGuid guid, uint8 teamId, BracketTraceReason reason, int fromRange, int toRange)
+{
+    BracketTraceRecord record;
+    record.timeMs = GameTime::GetGameTimeMS().count();
+    record.guid = guid.GetCounter();
+    record.fromRange = static_cast<int16>(fromRange);
+    record.toRange = static_cast<int16>(toRange);
+    record.reason = reason;
+    record.teamId = teamId;
+    g_DecisionTrace.Push(record);
+}
+
+
+/**
+ * @brief Returns the microseconds elapsed since a steady clock time point.
+ */
+static uint64 GetMicrosSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+// -----------------------------------------------------------------------------
+// BOT CENSUS
+// -----------------------------------------------------------------------------
+// Live histogram of online random bots, kept current from the login, logout and
+// level-change hooks so the distribution check does not have to walk the player map.
+static constexpr uint32 CENSUS_LEVEL_SLOTS = BRACKET_LEVEL_SLOTS;
+static_assert(CENSUS_LEVEL_SLOTS == STRONG_MAX_LEVEL + 1, "Census needs one slot per level");
+
+struct BotCensusEntry
+{
+    uint8 teamId;
+    uint8 classId;
+    uint8 level;
+};
+
+// Random bot counts per faction, class and level.
+static uint32 g_BotCensus[2][MAX_CLASSES][CENSUS_LEVEL_SLOTS] = {};
+// Random bot counts per faction and level (sum over classes).
+static uint32 g_BotCensusByLevel[2][CENSUS_LEVEL_SLOTS] = {};
+// What each counted bot was recorded as, so logout and level changes can be undone exactly.
+static std::unordered_map<ObjectGuid, BotCensusEntry> g_BotCensusMembers;
+// Players that were not random bots at login. Alt bots are weeded out lazily.
+static std::unordered_set<ObjectGuid> g_CensusRealPlayers;
+// Set while a map update thread runs a level reset. The census belongs to the world thread, which
+// records the new level once it collects the reset.
+static thread_local bool g_RunningMapThreadReset = false;
+// Bots whose level changed. The level hook also fires on the map update threads, for instance when a
+// bot levels from XP, so the census is brought up to date on the world thread.
+static std::mutex g_CensusLevelChangesLock;
+static std::vector<ObjectGuid> g_CensusLevelChanges;
+
+// Level-to-bracket lookup tables of both factions, rebuilt whenever bracket bounds change.
+static BracketLookupTables g_BracketLookup;
+// Brackets of each faction that went over their deadband and are still shedding their surplus.
+static std::vector<bool> g_BracketCorrecting[2];
+
+// -----------------------------------------------------------------------------
+// BOT ELIGIBILITY CACHE
+// -----------------------------------------------------------------------------
+// Why a bot is left alone by the module. Only reasons whose option is enabled are ever set.
+enum BotExclusionReason : uint8
+{
+    BOT_EXCLUSION_NONE        = 0x00,
+    BOT_EXCLUSION_NAME        = 0x01, ///< Listed in BotLevelBrackets.ExcludeNames
+    BOT_EXCLUSION_GUILD       = 0x02, ///< In a guild with real players
+    BOT_EXCLUSION_FRIEND      = 0x04, ///< On a real player's friends list
+    BOT_EXCLUSION_ARENA_TEAM  = 0x08, ///< In an arena team
+    BOT_EXCLUSION_REAL_GROUP  = 0x10  ///< Grouped with a real player
+};
+
+struct BotEligibilityRecord
+{
+    uint32 generation = 0;        ///< Matches g_BotEligibilityGeneration while the record is valid
+    uint8 reasons = BOT_EXCLUSION_NONE;
+    bool hasArenaTeamId = false;  ///< Arena team slots were non-empty when the record was computed
 };
-static std::vector<PendingResetEntry> g_PendingLevelResets;
+
+// Eligibility records indexed by GUID counter.
+static std::vector<BotEligibilityRecord> g_BotEligibility;
+// Advanced whenever something that can change every bot's eligibility happens.
+static uint32 g_BotEligibilityGeneration = 1;
+
+// Invalidations reported by the group and guild hooks, which also fire on the map update threads.
+// ProcessEligibilityInvalidations() applies them on the world thread.
+static std::mutex g_EligibilityInvalidationsLock;
+static std::vector<ObjectGuid::LowType> g_InvalidatedBots;
+static std::vector<ObjectGuid::LowType> g_InvalidatedGroups;
+static std::atomic<bool> g_InvalidateAllEligibility{false};
+
+
+/**
+ * @brief Drops the cached eligibility of a single character.
+ *
+ * @param counter GUID counter of the character.
+ */
+static void InvalidateBotEligibility(ObjectGuid::LowType counter)
+{
+    if (counter < g_BotEligibility.size())
+    {
+        g_BotEligibility[counter].generation = 0;
+    }
+}
+
+
+/**
+ * @brief Drops the cached eligibility of every bot.
+ */
+static void InvalidateAllBotEligibility()
+{
+    // Generation 0 marks an invalid record, so skip it on wrap-around.
+    if (++g_BotEligibilityGeneration == 0)
+    {
+        g_BotEligibility.assign(g_BotEligibility.size(), BotEligibilityRecord());
+        g_BotEligibilityGeneration = 1;
+    }
+}
+
+
+/**
+ * @brief Drops the cached eligibility of every online member of a group.
+ *
+ * @param group The group, may be null.
+ */
+static void InvalidateGroupEligibility(Group* group)
+{
+    if (!group)
+    {
+        return;
+    }
+    for (GroupReference* ref = group->GetFirstMember(); ref; ref = ref->next())
+    {
+        if (Player* member = ref->GetSource())
+        {
+            InvalidateBotEligibility(member->GetGUID().GetCounter());
+        }
+    }
+}
+
+
+/**
+ * @brief Queues the invalidation of a character's cached eligibility. Safe to call from any thread.
+ *
+ * @param counter GUID counter of the character.
+ */
+static void QueueBotEligibilityInvalidation(ObjectGuid::LowType counter)
+{
+    std::lock_guard<std::mutex> guard(g_EligibilityInvalidationsLock);
+    g_InvalidatedBots.push_back(counter);
+}
+
+
+/**
+ * @brief Queues the invalidation of every member of a group. Safe to call from any thread.
+ *
+ * Only the group's GUID is read here; its member list is walked on the world thread.
+ *
+ * @param group The group, may be null.
+ */
+static void QueueGroupEligibilityInvalidation(Group* group)
+{
+    if (!group)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(g_EligibilityInvalidationsLock);
+    g_InvalidatedGroups.push_back(group->GetGUID().GetCounter());
+}
+
+
+/**
+ * @brief Applies the queued eligibility invalidations. Called from the world thread on every tick.
+ */
+static void ProcessEligibilityInvalidations()
+{
+    if (g_InvalidateAllEligibility.exchange(false))
+    {
+        InvalidateAllBotEligibility();
+    }
+
+    std::vector<ObjectGuid::LowType> bots;
+    std::vector<ObjectGuid::LowType> groups;
+    {
+        std::lock_guard<std::mutex> guard(g_EligibilityInvalidationsLock);
+        if (g_InvalidatedBots.empty() && g_InvalidatedGroups.empty())
+        {
+            return;
+        }
+        bots.swap(g_InvalidatedBots);
+        groups.swap(g_InvalidatedGroups);
+    }
+
+    for (ObjectGuid::LowType counter : bots)
+    {
+        InvalidateBotEligibility(counter);
+    }
+    for (ObjectGuid::LowType groupId : groups)
+    {
+        // A group disbanded since is covered by g_InvalidateAllEligibility.
+        InvalidateGroupEligibility(sGroupMgr->GetGroupByGUID(groupId));
+    }
+}
+
+
+/**
+ * @brief Unmaps the stats segment, if one is mapped. The file is left in place.
+ */
+static void CloseStatsSegment()
+{
+#if AC_PLATFORM != AC_PLATFORM_WINDOWS
+    if (g_StatsSegment)
+    {
+        munmap(g_StatsSegment, sizeof(BracketStatsSegment));
+    }
+#endif
+    g_StatsSegment = nullptr;
+    g_StatsSegmentPath.clear();
+}
+
+
+/**
+ * @brief Maps the stats segment named by BotLevelBrackets.StatsFile, creating the file if needed.
+ *
+ * Does nothing when the configured file is already mapped. Failures are logged and leave
+ * publishing disabled; the rest of the module is unaffected.
+ */
+static void OpenStatsSegment()
+{
+    if (g_StatsFile == g_StatsSegmentPath && (g_StatsSegment || g_StatsFile.empty()))
+    {
+        return;
+    }
+    CloseStatsSegment();
+    if (g_StatsFile.empty())
+    {
+        return;
+    }
+
+#if AC_PLATFORM != AC_PLATFORM_WINDOWS
+    int fd = open(g_StatsFile.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        LOG_ERROR("server.loading", "[BotLevelBrackets] Could not open stats file '{}'. Stats publishing disabled.", g_StatsFile);
+        return;
+    }
+    void* address = MAP_FAILED;
+    if (ftruncate(fd, sizeof(BracketStatsSegment)) == 0)
+    {
+        address = mmap(nullptr, sizeof(BracketStatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (address == MAP_FAILED)
+    {
+        LOG_ERROR("server.loading", "[BotLevelBrackets] Could not map stats file '{}'. Stats publishing disabled.", g_StatsFile);
+        return;
+    }
+
+    g_StatsSegment = new (address) BracketStatsSegment();
+    g_StatsSegment->magic = BRACKET_STATS_MAGIC;
+    g_StatsSegment->version = BRACKET_STATS_VERSION;
+    g_StatsSegment->size = sizeof(BracketStatsSegment);
+    g_StatsSegmentPath = g_StatsFile;
+    LOG_INFO("server.loading", "[BotLevelBrackets] Publishing stats to '{}'.", g_StatsFile);
+#else
+    LOG_ERROR("server.loading", "[BotLevelBrackets] BotLevelBrackets.StatsFile is not supported on this platform.");
+#endif
+}
+
+
+/**
+ * @brief Rebuilds the level-to-bracket lookup tables of both factions.
+ *
+ * Must be called whenever bracket bounds change, i.e. after the configuration is loaded and after
+ * every dynamic re-weighting.
+ */
+static void RebuildBracketLookupTables()
+{
+    g_BracketLookup.Rebuild(TEAM_ALLIANCE, g_AllianceLevelRanges, g_NumRanges, g_RandomBotMinLevel, g_RandomBotMaxLevel);
+    g_BracketLookup.Rebuild(TEAM_HORDE, g_HordeLevelRanges, g_NumRanges, g_RandomBotMinLevel, g_RandomBotMaxLevel);
+}
+
+
+/**
+ * @brief Returns the nearest bracket a player of the given class may be assigned to.
+ *
+ * @param level The player's level.
+ * @param teamId The faction (TEAM_ALLIANCE or TEAM_HORDE).
+ * @param classId The player's class.
+ * @return int The bracket index, or -1 if no bracket is eligible or the faction is invalid.
+ */
+static int GetNearestBracketIndex(uint8 level, uint8 teamId, uint8 classId)
+{
+    uint8 group = (classId == CLASS_DEATH_KNIGHT) ? BRACKET_CLASS_GROUP_DEATH_KNIGHT : BRACKET_CLASS_GROUP_DEFAULT;
+    return g_BracketLookup.NearestBracket(teamId, group, level);
+}
 
 
 /**
@@ -124,20 +571,65 @@ static void LoadBotLevelBracketsConfig()
     g_GuildTrackerUpdateFrequency = sConfigMgr->GetOption<uint32>("BotLevelBrackets.GuildTrackerUpdateFrequency", 600);
     g_UseDynamicDistribution = sConfigMgr->GetOption<bool>("BotLevelBrackets.Dynamic.UseDynamicDistribution", false);
     g_RealPlayerWeight = sConfigMgr->GetOption<float>("BotLevelBrackets.Dynamic.RealPlayerWeight", 1.0f);
+    g_RealPlayerHalfLife = sConfigMgr->GetOption<uint32>("BotLevelBrackets.Dynamic.RealPlayerHalfLife", 0);
+    g_ProfileEnabled = sConfigMgr->GetOption<bool>("BotLevelBrackets.Dynamic.Profile.Enabled", false);
+    g_ProfileMemoryDays = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("BotLevelBrackets.Dynamic.Profile.MemoryDays", 7));
+    g_ProfileQuietPercent = std::clamp(sConfigMgr->GetOption<float>("BotLevelBrackets.Dynamic.Profile.QuietPercent", 50.0f), 0.0f, 100.0f);
     g_SyncFactions = sConfigMgr->GetOption<bool>("BotLevelBrackets.Dynamic.SyncFactions", false);
     g_IgnoreFriendListed = sConfigMgr->GetOption<bool>("BotLevelBrackets.IgnoreFriendListed", true);
     g_FlaggedProcessLimit = sConfigMgr->GetOption<uint32>("BotLevelBrackets.FlaggedProcessLimit", 5);
-
+    g_FlaggedProcessBudgetMs = sConfigMgr->GetOption<uint32>("BotLevelBrackets.FlaggedProcessBudgetMs", 0);
+    g_ScanSliceSize = sConfigMgr->GetOption<uint32>("BotLevelBrackets.ScanSliceSize", 0);
+    g_ScanSliceBudgetMs = sConfigMgr->GetOption<uint32>("BotLevelBrackets.ScanSliceBudgetMs", 0);
+    g_StagedResets = sConfigMgr->GetOption<bool>("BotLevelBrackets.StagedResets", false);
+    g_StagedResetStagesPerTick = sConfigMgr->GetOption<uint32>("BotLevelBrackets.StagedResetStagesPerTick", 4);
+    g_MapThreadResets = sConfigMgr->GetOption<bool>("BotLevelBrackets.MapThreadResets", false);
+    g_MapThreadResetsPerUpdate = sConfigMgr->GetOption<uint32>("BotLevelBrackets.MapThreadResetsPerUpdate", 1);
+    g_SurplusDeadband.absolute = sConfigMgr->GetOption<uint32>("BotLevelBrackets.Deadband.Absolute", 0);
+    g_SurplusDeadband.percent = std::max(0.0f, sConfigMgr->GetOption<float>("BotLevelBrackets.Deadband.Percent", 0.0f));
+    g_SurplusDeadband.release = sConfigMgr->GetOption<uint32>("BotLevelBrackets.Deadband.Release", 0);
+    g_ResetRatePerHour = sConfigMgr->GetOption<uint32>("BotLevelBrackets.ResetRate.PerHour", 0);
+    g_ResetRateBurst = sConfigMgr->GetOption<uint32>("BotLevelBrackets.ResetRate.Burst", 20);
+    g_FactionResetRatePerHour = sConfigMgr->GetOption<uint32>("BotLevelBrackets.ResetRate.FactionPerHour", 0);
+    g_FactionResetRateBurst = sConfigMgr->GetOption<uint32>("BotLevelBrackets.ResetRate.FactionBurst", 10);
+    g_StatsFile = sConfigMgr->GetOption<std::string>("BotLevelBrackets.StatsFile", "");
+    g_TraceDumpOnShutdown = sConfigMgr->GetOption<bool>("BotLevelBrackets.TraceDumpOnShutdown", true);
+    g_PersistFrequency = sConfigMgr->GetOption<uint32>("BotLevelBrackets.PersistFrequency", 300);
+    g_RestoreGracePeriod = sConfigMgr->GetOption<uint32>("BotLevelBrackets.RestoreGracePeriod", 600);
+    g_LoginBracketAssignment = sConfigMgr->GetOption<bool>("BotLevelBrackets.LoginBracketAssignment", false);
+    g_SampleNewBotLevels = sConfigMgr->GetOption<bool>("BotLevelBrackets.SampleNewBotLevels", false);
+    g_OfflineRebalance = sConfigMgr->GetOption<bool>("BotLevelBrackets.OfflineRebalance.Enabled", false);
+    g_OfflineRebalanceFrequency = sConfigMgr->GetOption<uint32>("BotLevelBrackets.OfflineRebalance.Frequency", 3600);
+    g_OfflineRebalanceMaxBots = sConfigMgr->GetOption<uint32>("BotLevelBrackets.OfflineRebalance.MaxBotsPerRun", 200);
+
+    // Names are normalized the way character names are stored, which makes the list case-insensitive,
+    // and resolved to GUIDs once here so the per-bot check is an integer lookup.
     std::string excludeNames = sConfigMgr->GetOption<std::string>("BotLevelBrackets.ExcludeNames", "");
+    g_ExcludeBotGuids.clear();
     g_ExcludeBotNames.clear();
     std::istringstream f(excludeNames);
     std::string s;
     while (getline(f, s, ',')) {
         s.erase(std::remove_if(s.begin(), s.end(), ::isspace), s.end());
-        if (!s.empty()) {
-            g_ExcludeBotNames.push_back(s);
+        if (s.empty()) {
+            continue;
+        }
+        if (!normalizePlayerName(s)) {
+            LOG_ERROR("server.loading", "[BotLevelBrackets] Invalid name '{}' in BotLevelBrackets.ExcludeNames, ignoring it.", s);
+            continue;
+        }
+        ObjectGuid guid = sCharacterCache->GetCharacterGuidByName(s);
+        if (!guid.IsEmpty()) {
+            g_ExcludeBotGuids.insert(guid.GetCounter());
+        } else {
+            g_ExcludeBotNames.insert(s);
         }
     }
+    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Exclusion list: {} names resolved, {} not found yet.",
+                 g_ExcludeBotGuids.size(), g_ExcludeBotNames.size());
+    }
 
     // Load the bot level restrictions.
     g_RandomBotMinLevel = static_cast<uint8>(sConfigMgr->GetOption<uint32>("AiPlayerbot.RandomBotMinLevel", 1));
@@ -184,6 +676,32 @@ static void LoadBotLevelBracketsConfig()
     }
 
     ClampAndBalanceBrackets();
+    RebuildBracketLookupTables();
+    InvalidateAllBotEligibility();
+
+    uint64 nowMs = GameTime::GetGameTimeMS().count();
+    g_ResetRateLimit.Configure(g_ResetRatePerHour, g_ResetRateBurst, nowMs);
+    g_FactionResetRateLimit[TEAM_ALLIANCE].Configure(g_FactionResetRatePerHour, g_FactionResetRateBurst, nowMs);
+    g_FactionResetRateLimit[TEAM_HORDE].Configure(g_FactionResetRatePerHour, g_FactionResetRateBurst, nowMs);
+
+    // A pass collected against the previous brackets cannot be planned against the new ones.
+    AbortDistributionScan();
+    g_BracketCorrecting[TEAM_ALLIANCE].assign(g_NumRanges, false);
+    g_BracketCorrecting[TEAM_HORDE].assign(g_NumRanges, false);
+    // Averages over the previous brackets do not carry over to the new ones.
+    g_RealPlayerCounts[TEAM_ALLIANCE].Reset();
+    g_RealPlayerCounts[TEAM_HORDE].Reset();
+    // Hourly profiles take days to learn, so they are only cleared when the brackets themselves change.
+    if (!g_HourlyProfiles[TEAM_ALLIANCE].Matches(g_AllianceLevelRanges, g_NumRanges))
+    {
+        g_HourlyProfiles[TEAM_ALLIANCE].Reset(g_AllianceLevelRanges, g_NumRanges);
+    }
+    if (!g_HourlyProfiles[TEAM_HORDE].Matches(g_HordeLevelRanges, g_NumRanges))
+    {
+        g_HourlyProfiles[TEAM_HORDE].Reset(g_HordeLevelRanges, g_NumRanges);
+    }
+
+    OpenStatsSegment();
 }
 
 
@@ -262,957 +780,3615 @@ static bool IsHordePlayerBot(Player* bot)
 /**
  * @brief Removes a bot from the list of pending level resets.
  *
- * This function searches the global g_PendingLevelResets container for any entries
- * that match the provided bot's GUID and removes them. It is used to ensure that
- * a bot is no longer scheduled for a pending level reset.
+ * This function removes the provided bot's GUID from the global g_PendingLevelResets queue.
+ * It is used to ensure that a bot is no longer scheduled for a pending level reset.
  *
  * @param bot Pointer to the Player object representing the bot to remove.
  */
 static void RemoveBotFromPendingResets(Player* bot)
 {
-    ObjectGuid guid = bot->GetGUID();
-    g_PendingLevelResets.erase(
-        std::remove_if(
-            g_PendingLevelResets.begin(),
-            g_PendingLevelResets.end(),
-            [guid](const PendingResetEntry& entry) { return entry.botGuid == guid; }
-        ),
-        g_PendingLevelResets.end()
-    );
+    g_PendingLevelResets.Remove(bot->GetGUID());
 }
 
 
 /**
- * @brief Loads the list of social friend GUIDs from the database into the global g_SocialFriendsList.
+ * @brief Adds a player to the live census.
  *
- * This function clears the existing g_SocialFriendsList and queries the CharacterDatabase
- * for all GUIDs marked as friends (flags = 1) in the character_social table. Each retrieved
- * GUID is added to the g_SocialFriendsList vector. If full debug mode is enabled, the function
- * logs the loading process and each GUID added.
+ * Random bots are counted in the per-faction, per-class, per-level histogram. Everyone else is
+ * remembered as a candidate real player; alt bots that end up in that set are removed the first
+ * time GetOnlineRealPlayers() sees their PlayerbotAI.
  *
- * The function returns immediately if the query fails or if no results are found.
+ * @param player Pointer to the Player object that logged in.
  */
-static void LoadSocialFriendList()
+static void CensusAddPlayer(Player* player)
 {
-    g_SocialFriendsList.clear();
-    QueryResult result = CharacterDatabase.Query("SELECT friend FROM character_social WHERE flags = 1");
-
-    if (!result)
+    if (!player)
     {
         return;
     }
-    if (result->GetRowCount() == 0)
+
+    ObjectGuid guid = player->GetGUID();
+    if (!IsPlayerRandomBot(player))
     {
+        g_CensusRealPlayers.insert(guid);
         return;
     }
-    if (g_BotDistFullDebugMode)
+
+    uint8 teamId = static_cast<uint8>(player->GetTeamId());
+    uint8 classId = player->getClass();
+    if (teamId > TEAM_HORDE || classId >= MAX_CLASSES || g_BotCensusMembers.count(guid))
     {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Fetching Social Friend List GUIDs into array");
+        return;
     }
 
-    do
-    {
-        uint32 socialFriendGUID = result->Fetch()->Get<uint32>();
-        g_SocialFriendsList.push_back(static_cast<uint64>(socialFriendGUID));
-        if (g_BotDistFullDebugMode)
-        {
-            LOG_INFO("server.load", "[BotLevelBrackets] Adding GUID {} to Social Friend List", socialFriendGUID);
-        }
-    } while (result->NextRow());
+    uint8 level = player->GetLevel();
+    g_BotCensusMembers[guid] = { teamId, classId, level };
+    g_BotCensus[teamId][classId][level]++;
+    g_BotCensusByLevel[teamId][level]++;
 }
 
 
 /**
- * @brief Loads the persistent guild tracker data from the database.
+ * @brief Removes a player from the live census.
  *
- * This function queries the bot_level_brackets_guild_tracker table to load all guild IDs
- * that have real players. This provides persistent storage of guild status even when
- * real players are offline. The data is loaded into g_PersistentRealPlayerGuildIds.
+ * @param player Pointer to the Player object that is logging out.
  */
-static void LoadPersistentGuildTracker()
+static void CensusRemovePlayer(Player* player)
 {
-    g_PersistentRealPlayerGuildIds.clear();
-    QueryResult result = CharacterDatabase.Query("SELECT guild_id FROM bot_level_brackets_guild_tracker WHERE has_real_players = 1");
-    
-    if (!result)
+    if (!player)
     {
-        if (g_BotDistFullDebugMode)
-        {
-            LOG_INFO("server.loading", "[BotLevelBrackets] No guilds with real players found in persistent storage.");
-        }
         return;
     }
-    
-    if (g_BotDistFullDebugMode)
-    {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Loading persistent guild tracker data from database...");
-    }
-    
-    do
-    {
-        uint32 guildId = result->Fetch()->Get<uint32>();
-        g_PersistentRealPlayerGuildIds.insert(guildId);
-        if (g_BotDistFullDebugMode)
-        {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Loaded guild {} as having real players.", guildId);
-        }
-    } while (result->NextRow());
-    
-    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+
+    ObjectGuid guid = player->GetGUID();
+    g_CensusRealPlayers.erase(guid);
+
+    auto itr = g_BotCensusMembers.find(guid);
+    if (itr == g_BotCensusMembers.end())
     {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Loaded {} guilds with real players from persistent storage.", g_PersistentRealPlayerGuildIds.size());
+        return;
     }
+
+    const BotCensusEntry& entry = itr->second;
+    g_BotCensus[entry.teamId][entry.classId][entry.level]--;
+    g_BotCensusByLevel[entry.teamId][entry.level]--;
+    g_BotCensusMembers.erase(itr);
 }
 
 
 /**
- * @brief Updates the persistent guild tracker database with current guild status.
+ * @brief Moves a counted random bot to its current level in the census histogram.
  *
- * This function adds guilds to the tracker when real players are found online in them.
- * It never removes guilds from the tracker when players log off - this prevents bot level
- * changes from occurring when real players go offline but are still members of the guild.
+ * Safe to call for any player; players not in the bot census and bots whose recorded
+ * level already matches are ignored. World thread only; does nothing on a map thread running a
+ * level reset. Level changes seen by the player hook go through QueueCensusLevelChange().
+ *
+ * @param player Pointer to the Player object whose level may have changed.
  */
-static void UpdatePersistentGuildTracker()
+static void CensusUpdateLevel(Player* player)
 {
-    if (g_BotDistFullDebugMode)
-    {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Starting additive-only persistent guild tracker update...");
-    }
-    
-    // Find guilds with currently online real players
-    std::unordered_set<uint32> currentRealPlayerGuilds;
-    
-    const auto& allPlayers = ObjectAccessor::GetPlayers();
-    for (const auto& itr : allPlayers)
+    if (!player || g_RunningMapThreadReset)
     {
-        Player* player = itr.second;
-        if (!player || !player->IsInWorld())
-            continue;
-            
-        if (!IsPlayerBot(player))
-        {
-            uint32 guildId = player->GetGuildId();
-            if (guildId != 0)
-            {
-                currentRealPlayerGuilds.insert(guildId);
-            }
-        }
+        return;
     }
-    
-    uint32 addedCount = 0;
-    
-    // Update or insert guilds with real players - ensure has_real_players is set to 1
-    for (uint32 guildId : currentRealPlayerGuilds)
+
+    auto itr = g_BotCensusMembers.find(player->GetGUID());
+    if (itr == g_BotCensusMembers.end())
     {
-        // Use REPLACE INTO to update existing records or insert new ones
-        CharacterDatabase.Execute(
-            "REPLACE INTO bot_level_brackets_guild_tracker (guild_id, has_real_players) "
-            "VALUES ({}, 1)",
-            guildId
-        );
-        
-        // Add to our in-memory cache
-        g_PersistentRealPlayerGuildIds.insert(guildId);
-        addedCount++;
+        return;
     }
-    
-    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+
+    BotCensusEntry& entry = itr->second;
+    uint8 level = player->GetLevel();
+    if (entry.level == level)
     {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Additive guild tracker update complete. {} guilds processed, {} total tracked guilds.", 
-                 addedCount, g_PersistentRealPlayerGuildIds.size());
+        return;
     }
+
+    g_BotCensus[entry.teamId][entry.classId][entry.level]--;
+    g_BotCensusByLevel[entry.teamId][entry.level]--;
+    entry.level = level;
+    g_BotCensus[entry.teamId][entry.classId][level]++;
+    g_BotCensusByLevel[entry.teamId][level]++;
 }
 
 
 /**
- * @brief Checks and removes guilds from tracker that no longer have any real players online.
+ * @brief Queues a level change for ProcessCensusLevelChanges(). Safe to call from any thread.
  *
- * This function scans all guilds currently in the tracker and removes any that don't have
- * real players online. This is useful for cleaning up after players leave guilds.
- * Should be called manually or as needed, not automatically on logout.
+ * @param player Pointer to the Player object whose level changed.
  */
-static void CleanupGuildTracker()
+static void QueueCensusLevelChange(Player* player)
 {
-    if (g_BotDistFullDebugMode)
-    {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Starting guild tracker cleanup - removing guilds with no online real players...");
-    }
-    
-    // Get current guilds with online real players
-    std::unordered_set<uint32> currentRealPlayerGuilds;
-    const auto& allPlayers = ObjectAccessor::GetPlayers();
-    for (const auto& itr : allPlayers)
-    {
-        Player* player = itr.second;
-        if (!player || !player->IsInWorld())
-            continue;
-            
-        if (!IsPlayerBot(player))
-        {
-            uint32 guildId = player->GetGuildId();
-            if (guildId != 0)
-            {
-                currentRealPlayerGuilds.insert(guildId);
-            }
-        }
-    }
-    
-    // Find guilds to remove (those in tracker but not in current real player guilds)
-    std::vector<uint32> guildsToRemove;
-    for (uint32 trackedGuildId : g_PersistentRealPlayerGuildIds)
+    std::lock_guard<std::mutex> guard(g_CensusLevelChangesLock);
+    g_CensusLevelChanges.push_back(player->GetGUID());
+}
+
+
+/**
+ * @brief Records the queued level changes in the census. Called from the world thread on every tick.
+ *
+ * Each bot is recorded at its level at this point, so changes queued in any order settle on the
+ * right level. Bots that logged out since were already taken out of the census.
+ */
+static void ProcessCensusLevelChanges()
+{
+    std::vector<ObjectGuid> changes;
     {
-        if (currentRealPlayerGuilds.find(trackedGuildId) == currentRealPlayerGuilds.end())
+        std::lock_guard<std::mutex> guard(g_CensusLevelChangesLock);
+        if (g_CensusLevelChanges.empty())
         {
-            guildsToRemove.push_back(trackedGuildId);
+            return;
         }
+        changes.swap(g_CensusLevelChanges);
     }
-    
-    // Remove guilds that no longer have real players online
-    uint32 removedCount = 0;
-    for (uint32 guildId : guildsToRemove)
+
+    for (ObjectGuid guid : changes)
     {
-        // Remove from database
-        CharacterDatabase.Execute(
-            "UPDATE bot_level_brackets_guild_tracker SET has_real_players = 0 WHERE guild_id = {}",
-            guildId
-        );
-        
-        // Remove from in-memory caches
-        g_PersistentRealPlayerGuildIds.erase(guildId);
-        g_RealPlayerGuildIds.erase(guildId);
-        removedCount++;
-        
-        if (g_BotDistFullDebugMode)
+        if (Player* player = ObjectAccessor::FindPlayer(guid))
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Removed guild {} from tracker - no real players online.", guildId);
+            CensusUpdateLevel(player);
         }
     }
-    
-    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
-    {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Guild tracker cleanup complete. {} guilds removed, {} guilds remain.", 
-                 removedCount, g_PersistentRealPlayerGuildIds.size());
-    }
 }
 
 
 /**
- * @brief Populates the global set of real player guild IDs from the provided player map.
- *
- * Iterates through the given map of players, and for each player that is not a bot and is currently in the world,
- * retrieves their guild ID. If the guild ID is non-zero, it is added to the global set of real player guild IDs.
- * The global set is cleared before population.
+ * @brief Rebuilds the census from the players currently in the world.
  *
- * @param players An unordered map associating ObjectGuids with Player pointers to process.
+ * Only needed when the hooks may have missed players, i.e. at startup.
  */
-static void LoadRealPlayerGuildIds(const std::unordered_map<ObjectGuid, Player*>& players)
+static void RebuildCensus()
 {
-    g_RealPlayerGuildIds.clear();
-    for (const auto& itr : players)
+    g_BotCensusMembers.clear();
+    g_CensusRealPlayers.clear();
+    for (auto& teamCounts : g_BotCensus)
     {
-        Player* player = itr.second;
-        if (!player || !player->IsInWorld())
+        for (auto& classCounts : teamCounts)
         {
-            continue;
+            std::fill(std::begin(classCounts), std::end(classCounts), 0);
         }
-        if (!IsPlayerBot(player))
+    }
+    for (auto& teamCounts : g_BotCensusByLevel)
+    {
+        std::fill(std::begin(teamCounts), std::end(teamCounts), 0);
+    }
+
+    for (const auto& itr : ObjectAccessor::GetPlayers())
+    {
+        Player* player = itr.second;
+        if (player && player->IsInWorld())
         {
-            uint32 guildId = player->GetGuildId();
-            if (guildId != 0)
-            {
-                g_RealPlayerGuildIds.insert(guildId);
-            }
+            CensusAddPlayer(player);
         }
     }
 }
 
 
 /**
- * @brief Returns the index of the level range that contains the specified level for the given team.
+ * @brief Returns the number of online random bots of a faction per level bracket.
  *
- * This function checks if the provided level is within the allowed random bot level range.
- * It then searches through the level ranges specific to the team (Alliance or Horde) and returns
- * the index of the range that contains the given level. If the level is not within any range or
- * the team ID is invalid, it returns -1.
+ * Counts are taken from prefix sums over the census histogram, so the cost depends on the
+ * number of levels and brackets rather than on the number of online players.
  *
- * @param level The level to check.
- * @param teamID The team identifier (TEAM_ALLIANCE or TEAM_HORDE).
- * @return int The index of the matching level range, or -1 if not found or out of bounds.
+ * @param teamId The faction to count (TEAM_ALLIANCE or TEAM_HORDE).
+ * @param ranges The level brackets of that faction.
+ * @param counts Output vector, resized to g_NumRanges, receiving the bot count per bracket.
+ * @return uint32 The total number of online random bots of that faction, in a bracket or not.
  */
-static int GetLevelRangeIndex(uint8 level, uint8 teamID)
+static uint32 GetCensusBracketCounts(uint8 teamId, const std::vector<LevelRangeConfig>& ranges, std::vector<int>& counts)
 {
-    if (level < g_RandomBotMinLevel || level > g_RandomBotMaxLevel)
+    if (teamId > TEAM_HORDE)
     {
-        return -1;
+        counts.assign(g_NumRanges, 0);
+        return 0;
     }
+    return GetBracketCountsFromHistogram(g_BotCensusByLevel[teamId], ranges, g_NumRanges, counts);
+}
+
 
-    if (teamID == TEAM_ALLIANCE)
+/**
+ * @brief Returns the real players currently in the world.
+ *
+ * Walks the census set of non-random-bot logins instead of the whole player map. Entries for
+ * players that are no longer connected, or that turned out to be alt bots, are dropped on the way.
+ *
+ * @return std::vector<Player*> The online real players.
+ */
+static std::vector<Player*> GetOnlineRealPlayers()
+{
+    std::vector<Player*> players;
+    players.reserve(g_CensusRealPlayers.size());
+    for (auto it = g_CensusRealPlayers.begin(); it != g_CensusRealPlayers.end(); )
     {
-        for (uint8 i = 0; i < g_NumRanges; ++i)
+        Player* player = ObjectAccessor::FindConnectedPlayer(*it);
+        if (!player || IsPlayerBot(player))
         {
-            if (level >= g_AllianceLevelRanges[i].lower && level <= g_AllianceLevelRanges[i].upper)
-            {
-                return i;
-            }
+            it = g_CensusRealPlayers.erase(it);
+            continue;
         }
-    }
-    else if (teamID == TEAM_HORDE)
-    {
-        for (uint8 i = 0; i < g_NumRanges; ++i)
+        if (player->IsInWorld())
         {
-            if (level >= g_HordeLevelRanges[i].lower && level <= g_HordeLevelRanges[i].upper)
-            {
-                return i;
-            }
+            players.push_back(player);
         }
+        ++it;
     }
-
-    return -1;
+    return players;
 }
 
 
 /**
- * @brief Returns a random level within the specified range.
- *
- * This function generates a random unsigned 8-bit integer (uint8) between the lower and upper bounds
- * (inclusive) defined in the provided LevelRangeConfig structure.
+ * @brief Records that an owner has a character on their friends list.
  *
- * @param range The LevelRangeConfig structure containing the lower and upper bounds for the level range.
- * @return uint8 A random level within the specified range [range.lower, range.upper].
+ * @param owner GUID counter of the character owning the friends list.
+ * @param friendLow GUID counter of the befriended character.
  */
-static uint8 GetRandomLevelInRange(const LevelRangeConfig& range)
+static void AddSocialFriend(ObjectGuid::LowType owner, ObjectGuid::LowType friendLow)
 {
-    return urand(range.lower, range.upper);
+    uint64 pairKey = (static_cast<uint64>(owner) << 32) | friendLow;
+    if (!g_SocialFriendPairs.insert(pairKey).second)
+    {
+        return;
+    }
+    ++g_SocialFriendRefs[friendLow];
+    InvalidateBotEligibility(friendLow);
 }
 
 
 /**
- * @brief Adjusts the level of a player bot to fit within a specified level range bracket.
+ * @brief Records that an owner removed a character from their friends list.
  *
- * This function ensures that the given bot is valid, in the world, and not in the process of logging out or being removed.
- * It then checks if the target range index is valid and, if the bot is mounted, dismounts it.
- * For Death Knight bots, it enforces a minimum level of 55, skipping adjustment if the target range is below this threshold.
- * The bot's level is then randomized within the specified range, and the bot is re-randomized using PlayerbotFactory.
- * Debug information is logged if enabled, and a system message is sent to the bot to notify about the level reset.
- *
- * @param bot Pointer to the Player object representing the bot to adjust.
- * @param targetRangeIndex Index of the target level range in the factionRanges array.
- * @param factionRanges Pointer to an array of LevelRangeConfig structures defining level brackets for the bot's faction.
+ * @param owner GUID counter of the character owning the friends list.
+ * @param friendLow GUID counter of the removed character.
  */
-static void AdjustBotToRange(Player* bot, int targetRangeIndex, const LevelRangeConfig* factionRanges)
+static void RemoveSocialFriend(ObjectGuid::LowType owner, ObjectGuid::LowType friendLow)
 {
-    if (!bot || !bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    uint64 pairKey = (static_cast<uint64>(owner) << 32) | friendLow;
+    if (g_SocialFriendPairs.erase(pairKey) == 0)
     {
         return;
     }
-    
-    if (targetRangeIndex < 0 || targetRangeIndex >= g_NumRanges)
+    auto itr = g_SocialFriendRefs.find(friendLow);
+    if (itr != g_SocialFriendRefs.end() && --itr->second == 0)
     {
-        return;
+        g_SocialFriendRefs.erase(itr);
+        InvalidateBotEligibility(friendLow);
     }
+}
 
-    if (bot->IsMounted())
+
+/**
+ * @brief Loads the friend index from the database.
+ *
+ * This function queues an asynchronous query for all friendships (flags = 1) in the character_social
+ * table whose owner is not on a random bot account; bots befriending each other can never protect a bot.
+ * The world thread does not wait for it: once the result lands, the callback (run from
+ * g_QueryProcessor during OnUpdate) builds a fresh index and swaps it in as a whole. Friend list
+ * changes seen while the query is in flight stay queued until then (see ProcessSocialFriendEvents()).
+ * If full debug mode is enabled, the function logs the loading process and each GUID added.
+ */
+static void LoadSocialFriendList()
+{
+    std::ostringstream sql;
+    sql << "SELECT cs.guid, cs.friend FROM character_social cs "
+           "JOIN characters c ON c.guid = cs.guid WHERE cs.flags = 1";
+    const std::vector<uint32>& botAccounts = sPlayerbotAIConfig->randomBotAccounts;
+    if (!botAccounts.empty())
     {
-        bot->Dismount();
+        sql << " AND c.account NOT IN (";
+        for (size_t i = 0; i < botAccounts.size(); ++i)
+        {
+            sql << (i ? "," : "") << botAccounts[i];
+        }
+        sql << ")";
     }
 
-    uint8 botOriginalLevel = bot->GetLevel();
-    uint8 newLevel = 0;
-
-    // For Death Knight bots, enforce a minimum level of 55.
-    if (bot->getClass() == CLASS_DEATH_KNIGHT)
+    g_SocialFriendListLoading = true;
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery(sql.str()).WithCallback([](QueryResult result)
     {
-        uint8 lowerBound = factionRanges[targetRangeIndex].lower;
-        uint8 upperBound = factionRanges[targetRangeIndex].upper;
-        if (upperBound < 55)
+        std::unordered_map<ObjectGuid::LowType, uint32> friendRefs;
+        std::unordered_set<uint64> friendPairs;
+        if (result)
         {
             if (g_BotDistFullDebugMode)
             {
-                std::string playerFaction = IsAlliancePlayerBot(bot) ? "Alliance" : "Horde";
-                LOG_INFO("server.loading",
-                         "[BotLevelBrackets] AdjustBotToRange: Cannot assign {} Death Knight '{}' ({}) to range {}-{} (below level 55).",
-                         playerFaction, bot->GetName(), botOriginalLevel, lowerBound, upperBound);
+                LOG_INFO("server.loading", "[BotLevelBrackets] Fetching Social Friend List GUIDs into index");
             }
-            return;
-        }
-        if (lowerBound < 55)
-        {
-            lowerBound = 55;
+            do
+            {
+                Field* fields = result->Fetch();
+                uint32 ownerGUID = fields[0].Get<uint32>();
+                uint32 socialFriendGUID = fields[1].Get<uint32>();
+                if (friendPairs.insert((static_cast<uint64>(ownerGUID) << 32) | socialFriendGUID).second)
+                {
+                    ++friendRefs[socialFriendGUID];
+                }
+                if (g_BotDistFullDebugMode)
+                {
+                    LOG_INFO("server.load", "[BotLevelBrackets] Adding GUID {} to Social Friend List", socialFriendGUID);
+                }
+            } while (result->NextRow());
         }
-        if (lowerBound > upperBound)
+
+        g_SocialFriendRefs.swap(friendRefs);
+        g_SocialFriendPairs.swap(friendPairs);
+        g_SocialFriendListLoading = false;
+        InvalidateAllBotEligibility();
+
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
         {
-            return;
+            LOG_INFO("server.loading", "[BotLevelBrackets] Loaded {} real player friendships covering {} characters.",
+                     g_SocialFriendPairs.size(), g_SocialFriendRefs.size());
         }
-        newLevel = urand(lowerBound, upperBound);
+    }));
+}
+
+
+/**
+ * @brief Applies the friend list changes queued by BotLevelBracketsServerScript to the friend index.
+ *
+ * Owners are resolved from their account's session, and events of players no longer in the world
+ * are skipped. Additions carry the friend's name as typed by the player and are resolved through
+ * the character cache. An addition the core later rejects (full list, unknown name, ...) still protects that
+ * character until the next restart, which errs on the side of leaving a bot alone.
+ */
+static void ProcessSocialFriendEvents()
+{
+    // Changes made while the index is being reloaded are applied on top of the new index.
+    if (g_SocialFriendListLoading)
+    {
+        return;
     }
-    else
+
+    std::vector<SocialFriendEvent> events;
     {
-        const LevelRangeConfig& range = factionRanges[targetRangeIndex];
-        if (range.lower > range.upper)
+        std::lock_guard<std::mutex> guard(g_SocialFriendEventsLock);
+        if (g_SocialFriendEvents.empty())
         {
-            if (g_BotDistFullDebugMode)
-            {
-                std::string playerFaction = IsAlliancePlayerBot(bot) ? "Alliance" : "Horde";
-                LOG_INFO("server.loading",
-                         "[BotLevelBrackets] AdjustBotToRange: Invalid range {}-{} for {} bot '{}'.",
-                         range.lower, range.upper, playerFaction, bot->GetName());
-            }
             return;
         }
-        newLevel = GetRandomLevelInRange(range);
+        events.swap(g_SocialFriendEvents);
     }
 
-    PlayerbotFactory newFactory(bot, newLevel);
-    newFactory.Randomize(false);
-
-    // Force reset talents if equipment persistence is enabled and bot rolled to max level
-    // This is to fix an issue with Playerbots and how Randomization works with Equipment Persistence
-    if (newLevel == g_RandomBotMaxLevel && sPlayerbotAIConfig->equipmentPersistence)
+    for (SocialFriendEvent& event : events)
     {
-        PlayerbotFactory tempFactory(bot, newLevel);
-        tempFactory.InitTalentsTree(false, true, true);
-    }
+        WorldSession* session = sWorldSessionMgr->FindSession(event.ownerAccountId);
+        Player* ownerPlayer = session ? session->GetPlayer() : nullptr;
+        if (!ownerPlayer)
+        {
+            continue;
+        }
+        ObjectGuid::LowType owner = ownerPlayer->GetGUID().GetCounter();
 
-    if (g_BotDistFullDebugMode)
-    {
-        PlayerbotAI* botAI = sPlayerbotsMgr->GetPlayerbotAI(bot);
-        std::string playerClassName = botAI ? botAI->GetChatHelper()->FormatClass(bot->getClass()) : "Unknown";
-        std::string playerFaction = IsAlliancePlayerBot(bot) ? "Alliance" : "Horde";
-        LOG_INFO("server.loading",
-                 "[BotLevelBrackets] AdjustBotToRange: {} Bot '{}' - {} ({}) adjusted to level {} (target range {}-{}).",
-                 playerFaction, bot->GetName(), playerClassName.c_str(), botOriginalLevel, newLevel,
-                 factionRanges[targetRangeIndex].lower, factionRanges[targetRangeIndex].upper);
+        if (event.added)
+        {
+            if (!normalizePlayerName(event.friendName))
+            {
+                continue;
+            }
+            ObjectGuid friendGuid = sCharacterCache->GetCharacterGuidByName(event.friendName);
+            if (!friendGuid.IsEmpty())
+            {
+                AddSocialFriend(owner, friendGuid.GetCounter());
+            }
+        }
+        else
+        {
+            RemoveSocialFriend(owner, event.friendGuid.GetCounter());
+        }
     }
-
-    ChatHandler(bot->GetSession()).SendSysMessage("[mod-bot-level-brackets] Your level has been reset.");
 }
 
 
 /**
- * @brief Checks if the given bot is in a guild that contains at least one real player.
- *
- * This function verifies several conditions to ensure the bot is valid and currently in the world,
- * has an active session, is not logging out, and is not in the process of being removed from the world.
- * It then checks if the bot is part of a guild and whether that guild is known to contain real players.
+ * @brief Loads the persistent guild tracker data from the database.
  *
- * @param bot Pointer to the Player object representing the bot.
- * @return true if the bot is in a guild with at least one real player, false otherwise.
+ * This function queries the bot_level_brackets_guild_tracker table to load all guild IDs
+ * that have real players. This provides persistent storage of guild status even when
+ * real players are offline. The query runs asynchronously; when its callback lands the
+ * loaded set is swapped into g_PersistentRealPlayerGuildIds in one step.
  */
-static bool BotInGuildWithRealPlayer(Player* bot)
+static void LoadPersistentGuildTracker()
 {
-    if (!bot || !bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
-    {
-        return false;
-    }
-    uint32 guildId = bot->GetGuildId();
-    if (guildId == 0)
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery("SELECT guild_id FROM bot_level_brackets_guild_tracker WHERE has_real_players = 1").WithCallback([](QueryResult result)
     {
-        return false;
-    }
-    // Check both online real players and persistent database storage
-    return g_RealPlayerGuildIds.count(guildId) > 0 || g_PersistentRealPlayerGuildIds.count(guildId) > 0;
+        if (!result)
+        {
+            if (g_BotDistFullDebugMode)
+            {
+                LOG_INFO("server.loading", "[BotLevelBrackets] No guilds with real players found in persistent storage.");
+            }
+            return;
+        }
+
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Loading persistent guild tracker data from database...");
+        }
+
+        std::unordered_set<uint32> guildIds;
+        do
+        {
+            uint32 guildId = result->Fetch()->Get<uint32>();
+            guildIds.insert(guildId);
+            if (g_BotDistFullDebugMode)
+            {
+                LOG_INFO("server.loading", "[BotLevelBrackets] Loaded guild {} as having real players.", guildId);
+            }
+        } while (result->NextRow());
+
+        // Keep guilds the tracker added while the query was in flight.
+        guildIds.insert(g_PersistentRealPlayerGuildIds.begin(), g_PersistentRealPlayerGuildIds.end());
+        g_PersistentRealPlayerGuildIds.swap(guildIds);
+        InvalidateAllBotEligibility();
+
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Loaded {} guilds with real players from persistent storage.", g_PersistentRealPlayerGuildIds.size());
+        }
+    }));
 }
 
 
 /**
- * @brief Checks if the given bot is present in any real player's friends list.
+ * @brief Writes a set of guild IDs to the guild tracker in batched multi-row statements.
  *
- * This function verifies if the provided bot player is valid, currently in the world,
- * has an active session, is not logging out, and is not being removed from the world.
- * It then iterates through the global friends list to determine if the bot's GUID
- * matches any entry, indicating that the bot is on a real player's friends list.
- * If debug mode is enabled, it logs additional information when a match is found.
+ * All statements go into a single transaction, GUILD_TRACKER_BATCH_ROWS guilds per statement.
  *
- * @param bot Pointer to the Player object representing the bot to check.
- * @return true if the bot is on a real player's friends list, false otherwise.
+ * @param guildIds The guild IDs to write.
+ * @param statementPrefix SQL placed before each list of guild IDs.
+ * @param insertRows True to emit "(id,1)" rows for an insert, false for a plain ID list for an IN clause.
+ * @param statementSuffix SQL placed after each list of guild IDs.
  */
-static bool BotInFriendList(Player* bot)
+static void WriteGuildTrackerBatch(const std::vector<uint32>& guildIds, const char* statementPrefix, bool insertRows, const char* statementSuffix)
 {
-    if (!bot || !bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    if (guildIds.empty())
     {
-        return false;
+        return;
     }
 
-    for (size_t i = 0; i < g_SocialFriendsList.size(); ++i)
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    for (size_t begin = 0; begin < guildIds.size(); begin += GUILD_TRACKER_BATCH_ROWS)
     {
-        if (g_SocialFriendsList[i] == bot->GetGUID().GetRawValue())
+        size_t end = std::min(guildIds.size(), begin + GUILD_TRACKER_BATCH_ROWS);
+        std::ostringstream sql;
+        sql << statementPrefix;
+        for (size_t i = begin; i < end; ++i)
         {
-            if (g_BotDistFullDebugMode)
+            sql << (i > begin ? "," : "");
+            if (insertRows)
             {
-                LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is on a Real Player's friends list", bot->GetName(), bot->GetLevel());
+                sql << "(" << guildIds[i] << ",1)";
+            }
+            else
+            {
+                sql << guildIds[i];
             }
-            return true;
         }
+        sql << statementSuffix;
+        trans->Append(sql.str());
     }
-    return false;
+    CharacterDatabase.CommitTransaction(trans);
 }
 
 
 /**
- * @brief Checks if the given bot is a member of any arena team.
- *
- * This function verifies that the provided Player pointer is valid and
- * checks all arena team slots to see if the bot is in any arena team.
+ * @brief Updates the persistent guild tracker database with current guild status.
  *
- * @param bot Pointer to the Player object representing the bot.
- * @return true if the bot is in an arena team, false otherwise.
- */
+ * This function adds guilds to the tracker when real players are found online in them.
+ * Only guilds that are not tracked yet are written, as one multi-row
+ * INSERT ... ON DUPLICATE KEY UPDATE per batch inside a single transaction, so rows that
+ * are already tracked are neither deleted nor have their last_updated rewritten.
+ * It never removes guilds from the tracker when players log off - this prevents bot level
+ * changes from occurring when real players go offline but are still members of the guild.
+ */
+static void UpdatePersistentGuildTracker()
+{
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Starting additive-only persistent guild tracker update...");
+    }
+    
+    // Find guilds with currently online real players
+    std::unordered_set<uint32> currentRealPlayerGuilds;
+    
+    for (Player* player : GetOnlineRealPlayers())
+    {
+        uint32 guildId = player->GetGuildId();
+        if (guildId != 0)
+        {
+            currentRealPlayerGuilds.insert(guildId);
+        }
+    }
+    
+    // Only guilds that are new since the last flush need a write.
+    std::vector<uint32> newGuilds;
+    for (uint32 guildId : currentRealPlayerGuilds)
+    {
+        if (g_PersistentRealPlayerGuildIds.count(guildId) == 0)
+        {
+            newGuilds.push_back(guildId);
+        }
+    }
+
+    // Insert new guilds, or flip has_real_players back to 1 for guilds removed by a cleanup.
+    WriteGuildTrackerBatch(newGuilds,
+        "INSERT INTO bot_level_brackets_guild_tracker (guild_id, has_real_players) VALUES ", true,
+        " ON DUPLICATE KEY UPDATE has_real_players = 1");
+
+    // Add to our in-memory cache
+    g_PersistentRealPlayerGuildIds.insert(newGuilds.begin(), newGuilds.end());
+    if (!newGuilds.empty())
+    {
+        InvalidateAllBotEligibility();
+    }
+
+    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Additive guild tracker update complete. {} guilds with online real players, {} newly written, {} total tracked guilds.",
+                 currentRealPlayerGuilds.size(), newGuilds.size(), g_PersistentRealPlayerGuildIds.size());
+    }
+}
+
+
+/**
+ * @brief Checks and removes guilds from tracker that no longer have any real players online.
+ *
+ * This function scans all guilds currently in the tracker and removes any that don't have
+ * real players online. This is useful for cleaning up after players leave guilds.
+ * Should be called manually or as needed, not automatically on logout.
+ */
+static void CleanupGuildTracker()
+{
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Starting guild tracker cleanup - removing guilds with no online real players...");
+    }
+    
+    // Get current guilds with online real players
+    std::unordered_set<uint32> currentRealPlayerGuilds;
+    for (Player* player : GetOnlineRealPlayers())
+    {
+        uint32 guildId = player->GetGuildId();
+        if (guildId != 0)
+        {
+            currentRealPlayerGuilds.insert(guildId);
+        }
+    }
+    
+    // Find guilds to remove (those in tracker but not in current real player guilds)
+    std::vector<uint32> guildsToRemove;
+    for (uint32 trackedGuildId : g_PersistentRealPlayerGuildIds)
+    {
+        if (currentRealPlayerGuilds.find(trackedGuildId) == currentRealPlayerGuilds.end())
+        {
+            guildsToRemove.push_back(trackedGuildId);
+        }
+    }
+    
+    // Remove guilds that no longer have real players online from the database in batches
+    WriteGuildTrackerBatch(guildsToRemove,
+        "UPDATE bot_level_brackets_guild_tracker SET has_real_players = 0 WHERE guild_id IN (", false, ")");
+
+    uint32 removedCount = 0;
+    for (uint32 guildId : guildsToRemove)
+    {
+        // Remove from in-memory caches
+        g_PersistentRealPlayerGuildIds.erase(guildId);
+        g_RealPlayerGuildIds.erase(guildId);
+        removedCount++;
+        
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Removed guild {} from tracker - no real players online.", guildId);
+        }
+    }
+    if (removedCount > 0)
+    {
+        InvalidateAllBotEligibility();
+    }
+    
+    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Guild tracker cleanup complete. {} guilds removed, {} guilds remain.", 
+                 removedCount, g_PersistentRealPlayerGuildIds.size());
+    }
+}
+
+
+/**
+ * @brief Populates the global set of real player guild IDs from the online real players.
+ *
+ * Iterates through the real players currently in the world (taken from the census rather than
+ * the whole player map) and adds each non-zero guild ID to the global set of real player guild IDs.
+ * The global set is replaced as a whole; cached bot eligibility is dropped if it changed.
+ */
+static void LoadRealPlayerGuildIds()
+{
+    std::unordered_set<uint32> guildIds;
+    for (Player* player : GetOnlineRealPlayers())
+    {
+        uint32 guildId = player->GetGuildId();
+        if (guildId != 0)
+        {
+            guildIds.insert(guildId);
+        }
+    }
+    if (guildIds != g_RealPlayerGuildIds)
+    {
+        g_RealPlayerGuildIds.swap(guildIds);
+        InvalidateAllBotEligibility();
+    }
+}
+
+
+/**
+ * @brief Returns the index of the level range that contains the specified level for the given team.
+ *
+ * The answer is read from the per-faction lookup table built by RebuildBracketLookupTables().
+ * If the level is not within the allowed random bot level range or any bracket, or the team ID
+ * is invalid, it returns -1.
+ *
+ * @param level The level to check.
+ * @param teamID The team identifier (TEAM_ALLIANCE or TEAM_HORDE).
+ * @return int The index of the matching level range, or -1 if not found or out of bounds.
+ */
+static int GetLevelRangeIndex(uint8 level, uint8 teamID)
+{
+    return g_BracketLookup.BracketOf(teamID, level);
+}
+
+
+/**
+ * @brief Returns a random level within the specified range.
+ *
+ * This function generates a random unsigned 8-bit integer (uint8) between the lower and upper bounds
+ * (inclusive) defined in the provided LevelRangeConfig structure.
+ *
+ * @param range The LevelRangeConfig structure containing the lower and upper bounds for the level range.
+ * @return uint8 A random level within the specified range [range.lower, range.upper].
+ */
+static uint8 GetRandomLevelInRange(const LevelRangeConfig& range)
+{
+    return urand(range.lower, range.upper);
+}
+
+
+/**
+ * @brief Picks the level a bot is reset to within a target range.
+ *
+ * Death Knight bots are never given a level below 55.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @param range The target level range.
+ * @return uint8 The new level, or 0 if the bot cannot be placed in the range.
+ */
+static uint8 ChooseBotResetLevel(Player* bot, const LevelRangeConfig& range)
+{
+    // For Death Knight bots, enforce a minimum level of 55.
+    if (bot->getClass() == CLASS_DEATH_KNIGHT)
+    {
+        uint8 lowerBound = range.lower;
+        uint8 upperBound = range.upper;
+        if (upperBound < 55)
+        {
+            if (g_BotDistFullDebugMode)
+            {
+                std::string playerFaction = IsAlliancePlayerBot(bot) ? "Alliance" : "Horde";
+                LOG_INFO("server.loading",
+                         "[BotLevelBrackets] AdjustBotToRange: Cannot assign {} Death Knight '{}' ({}) to range {}-{} (below level 55).",
+                         playerFaction, bot->GetName(), bot->GetLevel(), lowerBound, upperBound);
+            }
+            return 0;
+        }
+        if (lowerBound < 55)
+        {
+            lowerBound = 55;
+        }
+        if (lowerBound > upperBound)
+        {
+            return 0;
+        }
+        return urand(lowerBound, upperBound);
+    }
+
+    if (range.lower > range.upper)
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            std::string playerFaction = IsAlliancePlayerBot(bot) ? "Alliance" : "Horde";
+            LOG_INFO("server.loading",
+                     "[BotLevelBrackets] AdjustBotToRange: Invalid range {}-{} for {} bot '{}'.",
+                     range.lower, range.upper, playerFaction, bot->GetName());
+        }
+        return 0;
+    }
+    return GetRandomLevelInRange(range);
+}
+
+
+/**
+ * @brief Logs and announces a completed level reset and records the new level in the census.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @param originalLevel The bot's level before the reset.
+ * @param newLevel The level the bot was reset to.
+ * @param range The target level range.
+ */
+static void FinishBotLevelReset(Player* bot, uint8 originalLevel, uint8 newLevel, const LevelRangeConfig& range)
+{
+    if (g_BotDistFullDebugMode)
+    {
+        PlayerbotAI* botAI = sPlayerbotsMgr->GetPlayerbotAI(bot);
+        std::string playerClassName = botAI ? botAI->GetChatHelper()->FormatClass(bot->getClass()) : "Unknown";
+        std::string playerFaction = IsAlliancePlayerBot(bot) ? "Alliance" : "Horde";
+        LOG_INFO("server.loading",
+                 "[BotLevelBrackets] AdjustBotToRange: {} Bot '{}' - {} ({}) adjusted to level {} (target range {}-{}).",
+                 playerFaction, bot->GetName(), playerClassName.c_str(), originalLevel, newLevel,
+                 range.lower, range.upper);
+    }
+
+    CensusUpdateLevel(bot);
+
+    ChatHandler(bot->GetSession()).SendSysMessage("[mod-bot-level-brackets] Your level has been reset.");
+}
+
+
+// -----------------------------------------------------------------------------
+// STAGED LEVEL RESETS
+// -----------------------------------------------------------------------------
+// With BotLevelBrackets.StagedResets enabled, a level reset is split into stages that run on
+// different ticks instead of one PlayerbotFactory::Randomize call.
+enum BotResetStage : uint8
+{
+    RESET_STAGE_LEVEL   = 0, ///< Dismount and set the new level
+    RESET_STAGE_SPELLS  = 1, ///< Skills, class spells and mounts
+    RESET_STAGE_TALENTS = 2, ///< Talents, glyphs and pet
+    RESET_STAGE_GEAR    = 3, ///< Equipment, bags and consumables
+    MAX_RESET_STAGES    = 4
+};
+
+struct StagedBotReset
+{
+    ObjectGuid botGuid;
+    uint8 teamId;
+    uint8 originalLevel;
+    uint8 newLevel;
+    LevelRangeConfig range;  ///< Copy of the target range, for the final log line
+    uint8 stage = RESET_STAGE_LEVEL;
+    bool postponed = false;  ///< A later stage was held back because the bot was busy
+};
+
+// Resets in progress, keyed by bot GUID.
+static std::unordered_map<ObjectGuid, StagedBotReset> g_StagedBotResets;
+// Round-robin order in which in-progress resets get their next stage.
+static std::deque<ObjectGuid> g_StagedBotResetOrder;
+
+
+/**
+ * @brief Starts a staged level reset. The first stage runs on the next call to ProcessStagedBotResets().
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @param newLevel The level to reset the bot to.
+ * @param range The target level range.
+ */
+static void QueueStagedBotReset(Player* bot, uint8 newLevel, const LevelRangeConfig& range)
+{
+    StagedBotReset reset;
+    reset.botGuid = bot->GetGUID();
+    reset.teamId = bot->GetTeamId() == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+    reset.originalLevel = bot->GetLevel();
+    reset.newLevel = newLevel;
+    reset.range = range;
+    if (g_StagedBotResets.emplace(reset.botGuid, reset).second)
+    {
+        g_StagedBotResetOrder.push_back(reset.botGuid);
+    }
+}
+
+
+/**
+ * @brief Drops the staged level reset of a bot, if any.
+ *
+ * A bot that already has its new level is recorded for a loadout refresh, so the stages it missed
+ * are made up for when it next logs in.
+ */
+static void CancelStagedBotReset(ObjectGuid guid)
+{
+    auto itr = g_StagedBotResets.find(guid);
+    if (itr == g_StagedBotResets.end())
+    {
+        return;
+    }
+    if (itr->second.stage > RESET_STAGE_LEVEL)
+    {
+        MarkBotForLoadoutRefresh(guid.GetCounter());
+    }
+    // The order queue entry is skipped once its reset is gone.
+    g_StagedBotResets.erase(itr);
+}
+
+
+/**
+ * @brief Runs one stage of a staged level reset.
+ *
+ * The stages use the factory steps of the playerbots maintenance command, which cover only part
+ * of PlayerbotFactory::Randomize. Unlike a full reset they leave the inventory and bank as they
+ * are, do not reset quests or initialise reputation, add no potions or other consumables beyond
+ * food, ammo and reagents, and skip the talent reset bookkeeping Randomize does before it picks
+ * talents. A staged bot therefore keeps items a fully reset bot would lose.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @param reset The reset in progress; its stage is advanced.
+ * @return true once the last stage has run.
+ */
+static bool RunBotResetStage(Player* bot, StagedBotReset& reset)
+{
+    PlayerbotFactory factory(bot, reset.newLevel);
+    switch (reset.stage)
+    {
+        case RESET_STAGE_LEVEL:
+            if (bot->IsMounted())
+            {
+                bot->Dismount();
+            }
+            // Levelling down must not leave spells of the old level behind.
+            if (reset.newLevel < bot->GetLevel())
+            {
+                bot->resetSpells();
+            }
+            bot->GiveLevel(reset.newLevel);
+            bot->SetUInt32Value(PLAYER_XP, 0);
+            CensusUpdateLevel(bot);
+            break;
+        case RESET_STAGE_SPELLS:
+            factory.InitSkills();
+            factory.InitClassSpells();
+            factory.InitAvailableSpells();
+            factory.InitSpecialSpells();
+            factory.InitMounts();
+            break;
+        case RESET_STAGE_TALENTS:
+            factory.InitTalentsTree(false, true, true);
+            factory.InitGlyphs(false);
+            factory.InitPet();
+            factory.InitPetTalents();
+            bot->SendTalentsInfoData(false);
+            break;
+        case RESET_STAGE_GEAR:
+            factory.InitEquipment(false);
+            factory.InitBags(false);
+            factory.InitAmmo();
+            factory.InitFood();
+            factory.InitReagents();
+            factory.InitKeyring();
+            if (bot->GetLevel() >= sPlayerbotAIConfig->minEnchantingBotLevel)
+            {
+                factory.ApplyEnchantAndGemsNew();
+            }
+            bot->DurabilityRepairAll(false, 1.0f, false);
+            break;
+        default:
+            break;
+    }
+    return ++reset.stage >= MAX_RESET_STAGES;
+}
+
+
+/**
+ * @brief Advances staged level resets, up to g_StagedResetStagesPerTick stages per call.
+ *
+ * Resets take turns, so many bots progress together and no single tick runs a full reset.
+ * Bots that left the world are dropped (see CancelStagedBotReset()). Runs while the module is
+ * disabled too, so no bot is left half reset.
+ *
+ * Every stage waits until the bot is idle: the first one until IsBotSafeForLevelReset() passes,
+ * the later ones until IsBotIdleForLevelReset() does, since the bot already has its new level.
+ * A reset that had to wait runs all its remaining stages at once as soon as the bot is idle
+ * again, so the bot is not left any longer at its new level without its spells and gear.
+ */
+static void ProcessStagedBotResets()
+{
+    uint32 stagesRun = 0;
+    size_t remaining = g_StagedBotResetOrder.size();
+    while (remaining-- > 0 && (g_StagedResetStagesPerTick == 0 || stagesRun < g_StagedResetStagesPerTick))
+    {
+        ObjectGuid guid = g_StagedBotResetOrder.front();
+        g_StagedBotResetOrder.pop_front();
+
+        auto itr = g_StagedBotResets.find(guid);
+        if (itr == g_StagedBotResets.end())
+        {
+            continue;
+        }
+
+        Player* bot = ObjectAccessor::FindPlayer(guid);
+        if (!bot || !bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+        {
+            ++g_Stats.resetsDropped;
+            TraceBotDecision(guid, itr->second.teamId, BRACKET_TRACE_STAGED_CANCELLED, -1, -1);
+            CancelStagedBotReset(guid);
+            continue;
+        }
+
+        StagedBotReset& reset = itr->second;
+        bool idle = (reset.stage == RESET_STAGE_LEVEL) ? IsBotSafeForLevelReset(bot) : IsBotIdleForLevelReset(bot);
+        if (!idle)
+        {
+            // Nothing has changed before the first stage, so only a started reset hurries afterwards.
+            reset.postponed = reset.stage != RESET_STAGE_LEVEL;
+            g_StagedBotResetOrder.push_back(guid);
+            continue;
+        }
+
+        bool finished = false;
+        do
+        {
+            ++stagesRun;
+            finished = RunBotResetStage(bot, reset);
+        } while (!finished && reset.postponed);
+
+        if (finished)
+        {
+            FinishBotLevelReset(bot, reset.originalLevel, reset.newLevel, reset.range);
+            g_StagedBotResets.erase(itr);
+            continue;
+        }
+        g_StagedBotResetOrder.push_back(guid);
+    }
+
+    if (g_StagedBotResets.empty())
+    {
+        g_StagedBotResetOrder.clear();
+    }
+}
+
+
+/**
+ * @brief Adjusts the level of a player bot to fit within a specified level range bracket.
+ *
+ * This function ensures that the given bot is valid, in the world, and not in the process of logging out or being removed.
+ * It then checks if the target range index is valid and, if the bot is mounted, dismounts it.
+ * For Death Knight bots, it enforces a minimum level of 55, skipping adjustment if the target range is below this threshold.
+ * The bot's level is then randomized within the specified range, and the bot is re-randomized using PlayerbotFactory,
+ * either in this call or, with BotLevelBrackets.StagedResets enabled, in stages over the next ticks.
+ * Debug information is logged if enabled, and a system message is sent to the bot to notify about the level reset.
+ *
+ * @param bot Pointer to the Player object representing the bot to adjust.
+ * @param targetRangeIndex Index of the target level range in the factionRanges array.
+ * @param factionRanges Pointer to an array of LevelRangeConfig structures defining level brackets for the bot's faction.
+ */
+static void AdjustBotToRange(Player* bot, int targetRangeIndex, const LevelRangeConfig* factionRanges)
+{
+    if (!bot || !bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    {
+        return;
+    }
+    
+    if (targetRangeIndex < 0 || targetRangeIndex >= g_NumRanges)
+    {
+        return;
+    }
+
+    if (bot->IsMounted())
+    {
+        bot->Dismount();
+    }
+
+    uint8 botOriginalLevel = bot->GetLevel();
+    uint8 newLevel = ChooseBotResetLevel(bot, factionRanges[targetRangeIndex]);
+    if (!newLevel)
+    {
+        return;
+    }
+
+    if (g_StagedResets)
+    {
+        QueueStagedBotReset(bot, newLevel, factionRanges[targetRangeIndex]);
+        return;
+    }
+
+    PlayerbotFactory newFactory(bot, newLevel);
+    newFactory.Randomize(false);
+
+    // Force reset talents if equipment persistence is enabled and bot rolled to max level
+    // This is to fix an issue with Playerbots and how Randomization works with Equipment Persistence
+    if (newLevel == g_RandomBotMaxLevel && sPlayerbotAIConfig->equipmentPersistence)
+    {
+        PlayerbotFactory tempFactory(bot, newLevel);
+        tempFactory.InitTalentsTree(false, true, true);
+    }
+
+    FinishBotLevelReset(bot, botOriginalLevel, newLevel, factionRanges[targetRangeIndex]);
+}
+
+
+// -----------------------------------------------------------------------------
+// MAP THREAD LEVEL RESETS
+// -----------------------------------------------------------------------------
+// With BotLevelBrackets.MapThreadResets enabled, ProcessPendingLevelResets() still picks the bots
+// to reset on the world thread, but hands each reset to the map the bot is on. The map runs it from
+// its own update, on one of the MapUpdate.Threads, and the world thread collects the outcome on the
+// next tick. Map threads only touch the bot and the queues below; the census, the statistics and
+// the decision trace stay on the world thread.
+
+// How long a handed off reset may wait for its map, in seconds, before it goes back to the pending queue.
+static constexpr uint32 MAP_THREAD_RESET_TIMEOUT = 60;
+
+// A reset waiting for its map thread.
+struct MapThreadReset
+{
+    ObjectGuid botGuid;
+    uint32 sequence;    ///< Tells a stale outcome apart from the current reset of the same bot
+    uint8 newLevel;
+    uint32 expiresAt;   ///< Game time after which the map skips the reset
+};
+
+// What a map thread did with a reset.
+struct MapThreadResetResult
+{
+    ObjectGuid botGuid;
+    uint32 sequence;
+    bool done;          ///< false if the bot had left the map or was no longer idle
+};
+
+// World thread record of a handed off reset.
+struct MapThreadResetInFlight
+{
+    PendingResetEntry entry;    ///< The pending reset, queued again if the map does not run it
+    uint32 sequence;
+    uint8 originalLevel;
+    uint8 newLevel;
+    int fromRange;
+    uint32 expiresAt;
+};
+
+// Resets waiting for their map, keyed by GetMapThreadResetKey().
+static std::mutex g_MapThreadResetQueuesLock;
+static std::unordered_map<uint64, std::deque<MapThreadReset>> g_MapThreadResetQueues;
+// Resets in all queues, so maps with nothing to do skip the lock.
+static std::atomic<uint32> g_MapThreadResetsQueued{0};
+// Outcomes posted by the map threads, collected by the world thread.
+static std::mutex g_MapThreadResetResultsLock;
+static std::vector<MapThreadResetResult> g_MapThreadResetResults;
+// Handed off resets, keyed by bot GUID. World thread only.
+static std::unordered_map<ObjectGuid, MapThreadResetInFlight> g_MapThreadResetsInFlight;
+static uint32 g_MapThreadResetSequence = 0;
+
+
+/**
+ * @brief Checks if a bot has a staged level reset in progress or a level reset handed to its map.
+ */
+static bool IsBotResetInProgress(ObjectGuid guid)
+{
+    return g_StagedBotResets.count(guid) > 0 || g_MapThreadResetsInFlight.count(guid) > 0;
+}
+
+
+/**
+ * @brief Returns the key of a map instance in g_MapThreadResetQueues.
+ */
+static uint64 GetMapThreadResetKey(const Map* map)
+{
+    return (uint64(map->GetId()) << 32) | map->GetInstanceId();
+}
+
+
+/**
+ * @brief Hands a pending level reset to the map the bot is on.
+ *
+ * The new level is picked here, so the map thread never reads the bracket configuration.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @param entry The pending reset of the bot.
+ * @param fromRange The bracket the bot is in, -1 if none.
+ * @return true if the reset was handed off, false if the bot cannot be placed in the target range.
+ */
+static bool DispatchMapThreadReset(Player* bot, const PendingResetEntry& entry, int fromRange)
+{
+    const LevelRangeConfig& range = entry.factionRanges[entry.targetRange];
+    uint8 newLevel = ChooseBotResetLevel(bot, range);
+    if (!newLevel)
+    {
+        return false;
+    }
+
+    MapThreadReset task;
+    task.botGuid = bot->GetGUID();
+    task.sequence = ++g_MapThreadResetSequence;
+    task.newLevel = newLevel;
+    task.expiresAt = GameTime::GetGameTime().count() + MAP_THREAD_RESET_TIMEOUT;
+
+    MapThreadResetInFlight& flight = g_MapThreadResetsInFlight[task.botGuid];
+    flight.entry = entry;
+    flight.sequence = task.sequence;
+    flight.originalLevel = bot->GetLevel();
+    flight.newLevel = newLevel;
+    flight.fromRange = fromRange;
+    flight.expiresAt = task.expiresAt;
+
+    {
+        std::lock_guard<std::mutex> lock(g_MapThreadResetQueuesLock);
+        g_MapThreadResetQueues[GetMapThreadResetKey(bot->GetMap())].push_back(task);
+    }
+    g_MapThreadResetsQueued.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+/**
+ * @brief Runs up to g_MapThreadResetsPerUpdate handed off resets of one map. Called from the map's update.
+ *
+ * Each reset runs the stages of a staged reset back to back, the same PlayerbotFactory steps the
+ * playerbots maintenance command already runs from map updates. Unlike PlayerbotFactory::Randomize
+ * they leave guilds and arena teams alone, which belong to the world thread; RunBotResetStage()
+ * lists the other differences.
+ *
+ * @param map The map being updated.
+ */
+static void RunMapThreadResets(Map* map)
+{
+    if (g_MapThreadResetsQueued.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    std::vector<MapThreadReset> tasks;
+    {
+        std::lock_guard<std::mutex> lock(g_MapThreadResetQueuesLock);
+        auto itr = g_MapThreadResetQueues.find(GetMapThreadResetKey(map));
+        if (itr == g_MapThreadResetQueues.end())
+        {
+            return;
+        }
+        std::deque<MapThreadReset>& queue = itr->second;
+        while (!queue.empty() && (g_MapThreadResetsPerUpdate == 0 || tasks.size() < g_MapThreadResetsPerUpdate))
+        {
+            tasks.push_back(queue.front());
+            queue.pop_front();
+        }
+        if (queue.empty())
+        {
+            g_MapThreadResetQueues.erase(itr);
+        }
+    }
+    g_MapThreadResetsQueued.fetch_sub(static_cast<uint32>(tasks.size()), std::memory_order_relaxed);
+
+    uint32 now = GameTime::GetGameTime().count();
+    std::vector<MapThreadResetResult> results;
+    results.reserve(tasks.size());
+    for (const MapThreadReset& task : tasks)
+    {
+        // Expired resets are already back in the pending queue.
+        if (now >= task.expiresAt)
+        {
+            continue;
+        }
+
+        Player* bot = ObjectAccessor::GetPlayer(map, task.botGuid);
+        bool done = bot && IsBotIdleForLevelReset(bot);
+        if (done)
+        {
+            StagedBotReset reset;
+            reset.botGuid = task.botGuid;
+            reset.originalLevel = bot->GetLevel();
+            reset.newLevel = task.newLevel;
+            g_RunningMapThreadReset = true;
+            while (!RunBotResetStage(bot, reset))
+            {
+            }
+            g_RunningMapThreadReset = false;
+        }
+        results.push_back({task.botGuid, task.sequence, done});
+    }
+
+    if (!results.empty())
+    {
+        std::lock_guard<std::mutex> lock(g_MapThreadResetResultsLock);
+        g_MapThreadResetResults.insert(g_MapThreadResetResults.end(), results.begin(), results.end());
+    }
+}
+
+
+/**
+ * @brief Collects the outcome of handed off resets. Called from the world thread on every tick.
+ *
+ * Finished resets are logged, announced and recorded in the census like any other reset. Bots that
+ * had left their map or were busy, and resets their map did not run in time, go back to the
+ * pending queue with their original age.
+ */
+static void CollectMapThreadResets()
+{
+    std::vector<MapThreadResetResult> results;
+    {
+        std::lock_guard<std::mutex> lock(g_MapThreadResetResultsLock);
+        results.swap(g_MapThreadResetResults);
+    }
+
+    for (const MapThreadResetResult& result : results)
+    {
+        Player* bot = ObjectAccessor::FindPlayer(result.botGuid);
+        auto itr = g_MapThreadResetsInFlight.find(result.botGuid);
+        if (itr == g_MapThreadResetsInFlight.end() || itr->second.sequence != result.sequence)
+        {
+            // The reset was cancelled at logout; the census still needs the bot's new level.
+            if (result.done && bot)
+            {
+                CensusUpdateLevel(bot);
+            }
+            continue;
+        }
+
+        MapThreadResetInFlight flight = itr->second;
+        g_MapThreadResetsInFlight.erase(itr);
+        const PendingResetEntry& entry = flight.entry;
+        if (result.done)
+        {
+            ++g_Stats.resetsDone;
+            TraceBotDecision(result.botGuid, entry.teamId, BRACKET_TRACE_RESET, flight.fromRange, entry.targetRange);
+            if (bot)
+            {
+                FinishBotLevelReset(bot, flight.originalLevel, flight.newLevel, entry.factionRanges[entry.targetRange]);
+            }
+        }
+        else if (bot)
+        {
+            TraceBotDecision(result.botGuid, entry.teamId, BRACKET_TRACE_NOT_SAFE, flight.fromRange, entry.targetRange);
+            g_PendingLevelResets.Push(entry);
+        }
+        else
+        {
+            ++g_Stats.resetsDropped;
+            TraceBotDecision(result.botGuid, entry.teamId, BRACKET_TRACE_DROPPED_OFFLINE, flight.fromRange, entry.targetRange);
+        }
+    }
+
+    uint32 now = GameTime::GetGameTime().count();
+    bool expired = false;
+    for (auto itr = g_MapThreadResetsInFlight.begin(); itr != g_MapThreadResetsInFlight.end();)
+    {
+        if (now < itr->second.expiresAt)
+        {
+            ++itr;
+            continue;
+        }
+        g_PendingLevelResets.Push(itr->second.entry);
+        itr = g_MapThreadResetsInFlight.erase(itr);
+        expired = true;
+    }
+
+    // Drop expired resets of maps that stopped updating, such as unloaded instances.
+    if (expired)
+    {
+        std::lock_guard<std::mutex> lock(g_MapThreadResetQueuesLock);
+        for (auto itr = g_MapThreadResetQueues.begin(); itr != g_MapThreadResetQueues.end();)
+        {
+            std::deque<MapThreadReset>& queue = itr->second;
+            size_t before = queue.size();
+            queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                       [now](const MapThreadReset& task) { return now >= task.expiresAt; }),
+                        queue.end());
+            g_MapThreadResetsQueued.fetch_sub(static_cast<uint32>(before - queue.size()), std::memory_order_relaxed);
+            itr = queue.empty() ? g_MapThreadResetQueues.erase(itr) : std::next(itr);
+        }
+    }
+}
+
+
+/**
+ * @brief Forgets the handed off reset of a bot, if any. Its outcome is ignored when it comes back.
+ */
+static void CancelMapThreadReset(ObjectGuid guid)
+{
+    g_MapThreadResetsInFlight.erase(guid);
+}
+
+
+/**
+ * @brief Checks if the given bot is in a guild that contains at least one real player.
+ *
+ * This function verifies several conditions to ensure the bot is valid and currently in the world,
+ * has an active session, is not logging out, and is not in the process of being removed from the world.
+ * It then checks if the bot is part of a guild and whether that guild is known to contain real players.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @return true if the bot is in a guild with at least one real player, false otherwise.
+ */
+static bool BotInGuildWithRealPlayer(Player* bot)
+{
+    if (!bot || !bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    {
+        return false;
+    }
+    uint32 guildId = bot->GetGuildId();
+    if (guildId == 0)
+    {
+        return false;
+    }
+    // Check both online real players and persistent database storage
+    return g_RealPlayerGuildIds.count(guildId) > 0 || g_PersistentRealPlayerGuildIds.count(guildId) > 0;
+}
+
+
+/**
+ * @brief Checks if the given bot is present in any real player's friends list.
+ *
+ * This function verifies if the provided bot player is valid, currently in the world,
+ * has an active session, is not logging out, and is not being removed from the world.
+ * It then looks the bot's GUID up in the friend index, where any entry means the bot
+ * is on a real player's friends list.
+ * If debug mode is enabled, it logs additional information when a match is found.
+ *
+ * @param bot Pointer to the Player object representing the bot to check.
+ * @return true if the bot is on a real player's friends list, false otherwise.
+ */
+static bool BotInFriendList(Player* bot)
+{
+    if (!bot || !bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    {
+        return false;
+    }
+
+    if (g_SocialFriendRefs.count(bot->GetGUID().GetCounter()) == 0)
+    {
+        return false;
+    }
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is on a Real Player's friends list", bot->GetName(), bot->GetLevel());
+    }
+    return true;
+}
+
+
+/**
+ * @brief Checks if the given bot is a member of any arena team.
+ *
+ * This function verifies that the provided Player pointer is valid and
+ * checks all arena team slots to see if the bot is in any arena team.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @return true if the bot is in an arena team, false otherwise.
+ */
 static bool BotInArenaTeam(Player* bot)
 {
-    if (!bot)
-        return false;
-    for (uint32 slot = 0; slot < MAX_ARENA_SLOT; ++slot)
+    if (!bot)
+        return false;
+    for (uint32 slot = 0; slot < MAX_ARENA_SLOT; ++slot)
+    {
+        if (ArenaTeam* team = sArenaTeamMgr->GetArenaTeamById(bot->GetArenaTeamId(slot)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief Clamps and balances the level brackets for Alliance and Horde bot distributions.
+ *
+ * This function ensures that the lower and upper bounds of each level bracket for both Alliance and Horde
+ * are within the allowed minimum and maximum bot levels. If a bracket's lower bound exceeds its upper bound,
+ * its desired percentage is set to zero. After clamping, the function checks if the sum of desired percentages
+ * for each faction equals 100. If not, and the total is greater than zero, it auto-adjusts the percentages
+ * upwards (one at a time, round-robin) until the sum reaches 100. Debug information is logged if enabled.
+ *
+ * Globals used:
+ * - g_AllianceLevelRanges: Array of Alliance level brackets.
+ * - g_HordeLevelRanges: Array of Horde level brackets.
+ * - g_NumRanges: Number of level brackets.
+ * - g_RandomBotMinLevel: Minimum allowed bot level.
+ * - g_RandomBotMaxLevel: Maximum allowed bot level.
+ * - g_BotDistFullDebugMode: Debug mode flag.
+ */
+static void ClampAndBalanceBrackets()
+{
+    uint32 totalAlliance = ClampAndBalanceRanges(g_AllianceLevelRanges, g_NumRanges, g_RandomBotMinLevel, g_RandomBotMaxLevel);
+    uint32 totalHorde = ClampAndBalanceRanges(g_HordeLevelRanges, g_NumRanges, g_RandomBotMinLevel, g_RandomBotMaxLevel);
+    if (g_BotDistFullDebugMode)
+    {
+        if (totalAlliance != 100 && totalAlliance > 0)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Alliance: Sum of percentages is {} (expected 100). Auto adjusted.", totalAlliance);
+        }
+        if (totalHorde != 100 && totalHorde > 0)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Horde: Sum of percentages is {} (expected 100). Auto adjusted.", totalHorde);
+        }
+    }
+}
+
+
+/**
+ * @brief Checks the bot's own state for a level reset, leaving out its group.
+ *
+ * Only reads the bot itself, so the map thread that owns the bot may call it.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @return true if the bot is idle enough for a level reset, false otherwise.
+ */
+static bool IsBotIdleForLevelReset(Player* bot)
+{
+    if (!bot || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Null bot pointer provided.");
+        }
+        return false;
+    }
+    if (!bot->IsInWorld())
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is not in world.", bot->GetName(), bot->GetLevel());
+        }
+        return false;
+    }
+    if (!bot->IsAlive())
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is not alive.", bot->GetName(), bot->GetLevel());
+        }
+        return false;
+    }
+    if (bot->IsInCombat())
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is in combat.", bot->GetName(), bot->GetLevel());
+        }
+        return false;
+    }
+    if (bot->InBattleground() || bot->InArena() || bot->inRandomLfgDungeon() || bot->InBattlegroundQueue())
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is in battleground, arena, random dungeon, or battleground queue.", bot->GetName(), bot->GetLevel());
+        }
+        return false;
+    }
+    if (bot->IsInFlight())
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is in flight.", bot->GetName(), bot->GetLevel());
+        }
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Checks if a bot is in a safe state to perform a level reset.
+ *
+ * This function verifies several conditions to ensure that the provided bot is safe for a level reset operation.
+ * The checks include:
+ * - The bot pointer and its session are valid and not in the process of logging out or being removed from the world.
+ * - The bot is currently in the world and alive.
+ * - The bot is not in combat.
+ * - The bot is not in a battleground, arena, random dungeon, or battleground queue.
+ * - The bot is not in flight.
+ * - If the bot is in a group, all group members must also be bots.
+ *
+ * If any of these conditions are not met, the function returns false. If debugging is enabled via
+ * g_BotDistFullDebugMode, detailed log messages are generated for each failure case.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @return true if the bot is safe for level reset, false otherwise.
+ */
+static bool IsBotSafeForLevelReset(Player* bot)
+{
+    if (!IsBotIdleForLevelReset(bot))
+    {
+        return false;
+    }
+    if (Group* group = bot->GetGroup())
+    {
+        for (GroupReference* ref = group->GetFirstMember(); ref; ref = ref->next())
+        {
+            Player* member = ref->GetSource();
+            if (member && member->IsInWorld() && !IsPlayerBot(member))
+            {
+                if (g_BotDistFullDebugMode)
+                {
+                    LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) has non-bot group member {} (Level {}).", bot->GetName(), bot->GetLevel(), member->GetName(), member->GetLevel());
+                }
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if a given bot is in the exclusion list for bracket processing.
+ *
+ * This function looks the bot's GUID up in `g_ExcludeBotGuids`, which is resolved from the
+ * BotLevelBrackets.ExcludeNames config at load time and completed by ResolveExcludedBotName() at login.
+ * If a match is found, this bot will not be considered for any bracket checks or level resets.
+ *
+ * @param bot Pointer to the Player object representing the bot to check.
+ * @return true if the bot is excluded from bracket processing, false otherwise.
+ */
+static bool IsBotExcluded(Player* bot)
+{
+    if (!bot)
+    {
+        return false;
+    }
+    return g_ExcludeBotGuids.count(bot->GetGUID().GetCounter()) > 0;
+}
+
+
+/**
+ * @brief Resolves an excluded name that had no character when the config was loaded.
+ *
+ * Covers characters created after the config was loaded. Called from the login hook.
+ *
+ * @param player The player that just logged in.
+ */
+static void ResolveExcludedBotName(Player* player)
+{
+    if (!player || g_ExcludeBotNames.empty())
+    {
+        return;
+    }
+    if (g_ExcludeBotNames.erase(player->GetName()) > 0)
+    {
+        g_ExcludeBotGuids.insert(player->GetGUID().GetCounter());
+    }
+}
+
+
+/**
+ * @brief Checks if the given bot is grouped with a real player who is in the world.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @return true if a group member is a real player, false otherwise.
+ */
+static bool BotInGroupWithRealPlayer(Player* bot)
+{
+    Group* group = bot ? bot->GetGroup() : nullptr;
+    if (!group)
+    {
+        return false;
+    }
+    for (GroupReference* ref = group->GetFirstMember(); ref; ref = ref->next())
+    {
+        Player* member = ref->GetSource();
+        if (member && member->IsInWorld() && !IsPlayerBot(member))
+        {
+            if (g_BotDistFullDebugMode)
+            {
+                LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is in group with real player {}.",
+                         bot->GetName(), bot->GetLevel(), member->GetName());
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief Returns why a bot is left alone by the module, using the eligibility cache.
+ *
+ * The exclusion name list, guild, friends list, arena team and group checks are evaluated once
+ * and cached per GUID counter until an event invalidates the record: a config reload, a change of
+ * the real player guild sets or the friend index, a guild or group membership change, or a login
+ * or logout. Arena team membership has no script hook, so the record also remembers whether the
+ * bot's arena team slots were empty and is recomputed when that changes.
+ * Bots that are not fully in the world are evaluated without touching the cache.
+ *
+ * @param bot Pointer to the Player object representing the bot.
+ * @return uint8 A mask of BotExclusionReason values; BOT_EXCLUSION_NONE if the bot is eligible.
+ */
+static uint8 GetBotExclusionReasons(Player* bot)
+{
+    if (!bot)
+    {
+        return BOT_EXCLUSION_NONE;
+    }
+
+    bool hasArenaTeamId = false;
+    for (uint32 slot = 0; slot < MAX_ARENA_SLOT; ++slot)
+    {
+        hasArenaTeamId = hasArenaTeamId || bot->GetArenaTeamId(slot) != 0;
+    }
+
+    ObjectGuid::LowType counter = bot->GetGUID().GetCounter();
+    if (counter < g_BotEligibility.size())
+    {
+        const BotEligibilityRecord& record = g_BotEligibility[counter];
+        if (record.generation == g_BotEligibilityGeneration && record.hasArenaTeamId == hasArenaTeamId)
+        {
+            return record.reasons;
+        }
+    }
+
+    uint8 reasons = BOT_EXCLUSION_NONE;
+    if (IsBotExcluded(bot))
+    {
+        reasons |= BOT_EXCLUSION_NAME;
+    }
+    if (g_IgnoreGuildBotsWithRealPlayers && BotInGuildWithRealPlayer(bot))
+    {
+        reasons |= BOT_EXCLUSION_GUILD;
+    }
+    if (g_IgnoreFriendListed && BotInFriendList(bot))
+    {
+        reasons |= BOT_EXCLUSION_FRIEND;
+    }
+    if (g_IgnoreArenaTeamBots && hasArenaTeamId && BotInArenaTeam(bot))
+    {
+        reasons |= BOT_EXCLUSION_ARENA_TEAM;
+    }
+    if (BotInGroupWithRealPlayer(bot))
+    {
+        reasons |= BOT_EXCLUSION_REAL_GROUP;
+    }
+
+    if (!bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    {
+        return reasons;
+    }
+
+    if (counter >= g_BotEligibility.size())
+    {
+        g_BotEligibility.resize(counter + 1);
+    }
+    g_BotEligibility[counter] = { g_BotEligibilityGeneration, reasons, hasArenaTeamId };
+    return reasons;
+}
+
+/**
+ * @brief Checks the census for brackets that hold more random bots than desired.
+ *
+ * For each faction the bracket counts come from GetCensusBracketCounts() and the desired counts from
+ * the current desiredPercent values. A surplus within the bracket's deadband does not count. Bots whose level falls outside every bracket also count as an
+ * imbalance, since they need to be flagged. The check costs O(levels + brackets) per faction.
+ *
+ * Bots that are later skipped by the scan (guild, friend list, arena, exclusions) are still counted
+ * here, so a positive answer only means a full scan is worth running.
+ *
+ * @return true if either faction has a surplus bracket or bots outside all brackets, false otherwise.
+ */
+static bool CensusShowsImbalance()
+{
+    std::vector<int> counts;
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+    {
+        const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+        uint32 total = GetCensusBracketCounts(teamId, ranges, counts);
+        if (total == 0)
+        {
+            continue;
+        }
+
+        uint32 inBrackets = 0;
+        for (uint8 i = 0; i < g_NumRanges; ++i)
+        {
+            inBrackets += counts[i];
+            int desired = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * total));
+            if (g_SurplusDeadband.ActionableSurplus(counts[i], desired, g_BracketCorrecting[teamId][i]) > 0)
+            {
+                return true;
+            }
+        }
+        if (inBrackets < total)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns how many random bots each bracket of a faction is missing according to the census.
+ *
+ * @param teamId The faction (TEAM_ALLIANCE or TEAM_HORDE).
+ * @param deficits Output vector, resized to g_NumRanges, receiving desired minus actual per bracket.
+ *                 Brackets over target get negative values.
+ */
+static void GetCensusBracketDeficits(uint8 teamId, std::vector<int>& deficits)
+{
+    const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+    uint32 total = GetCensusBracketCounts(teamId, ranges, deficits);
+    for (uint8 i = 0; i < g_NumRanges; ++i)
+    {
+        deficits[i] = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * total)) - deficits[i];
+    }
+}
+
+/**
+ * @brief Processes the pending level reset requests for player bots.
+ *
+ * This function walks the global queue of pending level resets (`g_PendingLevelResets`) in priority
+ * order and attempts to reset the level of each eligible bot to a specified range. Bots assigned a
+ * bracket as they logged in go first, then bots headed for the bracket with the biggest current deficit
+ * (taken from the census), then the oldest entries, alternating between Alliance and Horde. The function enforces a configurable limit
+ * (`g_FlaggedProcessLimit`) on the number of resets processed per cycle.
+ *
+ * When `g_FlaggedProcessBudgetMs` is set, the count limit is replaced by a wall-clock budget measured
+ * with a steady clock: resets keep being taken while the elapsed time plus the estimated cost of one more
+ * reset fits in the budget, and the rest carries over to the next cycle. The estimate is a moving average
+ * of the measured cost of each AdjustBotToRange call. At least one reset is always attempted per cycle.
+ *
+ * Resets also draw from token buckets, one over both factions (`g_ResetRateLimit`) and one per faction
+ * (`g_FactionResetRateLimit`). When the global bucket runs dry the cycle ends; when a faction's bucket
+ * runs dry the rest of its bots are skipped without being looked up. Either way the bots stay queued
+ * until the buckets refill, and the cycle counts once in `g_Stats.resetsRateLimited`.
+ *
+ * Bots are skipped and removed from the pending queue if:
+ *   - The bot is not found (once the restore grace period after startup is over) or not in the world.
+ *   - The bot's session is invalid, logging out, or being removed from the world.
+ *   - The bot is in a guild with real players and `g_IgnoreGuildBotsWithRealPlayers` is enabled.
+ *   - The bot is in a friend list and `g_IgnoreFriendListed` is enabled.
+ *
+ * If a bot is eligible and safe for a level reset, its level is adjusted to the target range using
+ * `AdjustBotToRange`. Debug information is logged if `g_BotDistFullDebugMode` is enabled.
+ *
+ * With `g_MapThreadResets` enabled, the reset is handed to the bot's map instead (see
+ * DispatchMapThreadReset()). The time budget does not apply then, but `g_FlaggedProcessLimit` still caps
+ * the hand-offs per cycle, whether or not a budget is set. The rate limits apply too, and each map runs at
+ * most `g_MapThreadResetsPerUpdate` resets per update.
+ *
+ * Urgent entries, such as bots assigned a bracket at login, go first and are not held back by the rate
+ * limits, although they use up tokens when there are any. Between two regular cycles OnUpdate calls this
+ * with `urgentOnly` on every tick that has urgent entries, so they are reset right away; the count and
+ * time limits then apply to each such call.
+ *
+ * The function returns immediately if there are no pending resets.
+ *
+ * @param urgentOnly Only process the urgent entries.
+ */
+static void ProcessPendingLevelResets(bool urgentOnly = false)
+{
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Processing {} pending resets...", g_PendingLevelResets.Size());
+    }
+    if (g_PendingLevelResets.Empty())
+    {
+        return;
+    }
+
+    using ResetClock = std::chrono::steady_clock;
+    const ResetClock::time_point cycleStart = ResetClock::now();
+    if (g_FlaggedProcessBudgetMs > 0 && g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Reset budget {} ms, estimated {:.2f} ms per reset, sizing this batch at about {} resets.",
+                 g_FlaggedProcessBudgetMs, g_ResetCostEstimateMs,
+                 g_ResetCostEstimateMs > 0.0 ? std::max<uint32>(1, static_cast<uint32>(g_FlaggedProcessBudgetMs / g_ResetCostEstimateMs)) : 1);
+    }
+
+    std::vector<int> deficits[2];
+    GetCensusBracketDeficits(TEAM_ALLIANCE, deficits[TEAM_ALLIANCE]);
+    GetCensusBracketDeficits(TEAM_HORDE, deficits[TEAM_HORDE]);
+
+    uint64 nowMs = GameTime::GetGameTimeMS().count();
+    g_ResetRateLimit.Refill(nowMs);
+    g_FactionResetRateLimit[TEAM_ALLIANCE].Refill(nowMs);
+    g_FactionResetRateLimit[TEAM_HORDE].Refill(nowMs);
+
+    // Factions whose quota is empty; their bots are skipped for the rest of the cycle.
+    bool factionHeld[2] = { !g_FactionResetRateLimit[TEAM_ALLIANCE].HasToken(), !g_FactionResetRateLimit[TEAM_HORDE].HasToken() };
+    bool rateLimited = false;
+
+    // Limit the number of resets processed in one cycle, by time or by count, if configured.
+    uint32 processed = 0;
+    for (ObjectGuid guid : g_PendingLevelResets.BuildProcessingOrder(deficits, urgentOnly))
+    {
+        const PendingResetEntry* entry = g_PendingLevelResets.Find(guid);
+        if (!entry)
+        {
+            continue;
+        }
+
+        // Urgent entries come first and are not held back by the quotas, though they still use up tokens.
+        if (!entry->urgent)
+        {
+            // Out of quota: the remaining bots stay queued until the buckets refill.
+            if (!g_ResetRateLimit.HasToken())
+            {
+                if (g_BotDistFullDebugMode)
+                {
+                    LOG_INFO("server.loading", "[BotLevelBrackets] Reset rate limit reached, {} resets left pending.", g_PendingLevelResets.Size());
+                }
+                rateLimited = true;
+                if (g_PendingLevelResets.MarkHeld(guid, BRACKET_TRACE_RATE_LIMITED))
+                {
+                    TraceBotDecision(guid, entry->teamId, BRACKET_TRACE_RATE_LIMITED, -1, entry->targetRange);
+                }
+                break;
+            }
+
+            if (factionHeld[entry->teamId])
+            {
+                rateLimited = true;
+                if (g_PendingLevelResets.MarkHeld(guid, BRACKET_TRACE_RATE_LIMITED))
+                {
+                    TraceBotDecision(guid, entry->teamId, BRACKET_TRACE_RATE_LIMITED, -1, entry->targetRange);
+                }
+                continue;
+            }
+        }
+
+        // Handing a reset off costs the world thread next to nothing, so only the count limit caps hand-offs.
+        if (g_FlaggedProcessBudgetMs > 0 && !g_MapThreadResets)
+        {
+            double elapsedMs = std::chrono::duration<double, std::milli>(ResetClock::now() - cycleStart).count();
+            if (processed > 0 && elapsedMs + g_ResetCostEstimateMs > g_FlaggedProcessBudgetMs)
+                break;
+        }
+        else if (g_FlaggedProcessLimit > 0 && processed >= g_FlaggedProcessLimit)
+            break;
+
+        int targetRange = entry->targetRange;
+        const LevelRangeConfig* factionRanges = entry->factionRanges;
+        uint8 teamId = entry->teamId;
+
+        Player* bot = ObjectAccessor::FindPlayer(guid);
+
+        if (!bot)
+        {
+            // Restored resets wait for their bots to log back in.
+            if (GameTime::GetGameTime().count() < g_RestoreGraceUntil)
+            {
+                continue;
+            }
+            g_PendingLevelResets.Remove(guid);
+            ++g_Stats.resetsDropped;
+            TraceBotDecision(guid, teamId, BRACKET_TRACE_DROPPED_OFFLINE, -1, targetRange);
+            continue;
+        }
+
+        if (!bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+        {
+            g_PendingLevelResets.Remove(guid);
+            ++g_Stats.resetsDropped;
+            TraceBotDecision(guid, teamId, BRACKET_TRACE_DROPPED_OFFLINE, -1, targetRange);
+            continue;
+        }
+
+        int fromRange = GetLevelRangeIndex(bot->GetLevel(), teamId);
+
+        // Excluded by name, guild, friends list, arena team, or now in a group with real players
+        if (GetBotExclusionReasons(bot) != BOT_EXCLUSION_NONE)
+        {
+            g_PendingLevelResets.Remove(guid);
+            ++g_Stats.resetsDropped;
+            TraceBotDecision(guid, teamId, BRACKET_TRACE_DROPPED_EXCLUDED, fromRange, targetRange);
+            continue;
+        }
+
+        ResetTokenBucket& factionRateLimit = g_FactionResetRateLimit[teamId];
+        if (!IsBotSafeForLevelReset(bot))
+        {
+            if (g_PendingLevelResets.MarkHeld(guid, BRACKET_TRACE_NOT_SAFE))
+            {
+                TraceBotDecision(guid, teamId, BRACKET_TRACE_NOT_SAFE, fromRange, targetRange);
+            }
+        }
+        else if (g_MapThreadResets)
+        {
+            PendingResetEntry handedOff = *entry;
+            g_PendingLevelResets.Remove(guid);
+            if (!DispatchMapThreadReset(bot, handedOff, fromRange))
+            {
+                ++g_Stats.resetsDropped;
+                TraceBotDecision(guid, teamId, BRACKET_TRACE_DROPPED_EXCLUDED, fromRange, targetRange);
+                continue;
+            }
+            g_ResetRateLimit.TakeToken();
+            factionRateLimit.TakeToken();
+            factionHeld[teamId] = !factionRateLimit.HasToken();
+            ++processed;
+        }
+        else
+        {
+            g_ResetRateLimit.TakeToken();
+            factionRateLimit.TakeToken();
+            factionHeld[teamId] = !factionRateLimit.HasToken();
+            const ResetClock::time_point resetStart = ResetClock::now();
+            AdjustBotToRange(bot, targetRange, factionRanges);
+            double costMs = std::chrono::duration<double, std::milli>(ResetClock::now() - resetStart).count();
+            // Feed the measured cost back into the estimate used to size the next batch.
+            g_ResetCostEstimateMs = (g_ResetCostEstimateMs > 0.0) ? g_ResetCostEstimateMs + 0.2 * (costMs - g_ResetCostEstimateMs) : costMs;
+            if (g_BotDistFullDebugMode)
+            {
+                LOG_INFO("server.loading", "[BotLevelBrackets] Bot '{}' successfully reset to level range {}-{}.", bot->GetName(), factionRanges[targetRange].lower, factionRanges[targetRange].upper);
+            }
+            g_PendingLevelResets.Remove(guid);
+            ++g_Stats.resetsDone;
+            TraceBotDecision(guid, teamId, BRACKET_TRACE_RESET, fromRange, targetRange);
+            ++processed;
+        }
+    }
+
+    if (rateLimited)
+    {
+        ++g_Stats.resetsRateLimited;
+    }
+}
+
+
+/**
+ * @brief Determines the level bracket index for a given player or flags the player for a level reset if not in any bracket.
+ *
+ * This function attempts to find the appropriate level range (bracket) for the specified player based on their level and faction.
+ * If the player is not currently within any defined bracket, the function finds the closest bracket and flags the player for a level reset,
+ * ensuring that each player is only flagged once. The function returns the index of the bracket if found, or -1 if the player is not in any bracket.
+ *
+ * @param player Pointer to the Player object whose bracket is to be determined.
+ * @param flagged Flags raised by the current distribution pass; a new flag is appended here.
+ * @return int The index of the level bracket if found, otherwise -1.
+ */
+static int GetOrFlagPlayerBracket(Player* player, PendingResetQueue& flagged)
+{
+    // Excluded bots, including bots in a group with real players, are left out of bracket processing
+    if (IsPlayerBot(player) && GetBotExclusionReasons(player) != BOT_EXCLUSION_NONE)
+    {
+        return -1;
+    }
+
+    int rangeIndex = GetLevelRangeIndex(player->GetLevel(), player->GetTeamId());
+    if (rangeIndex >= 0)
+    {
+        return rangeIndex;
+    }
+
+    LevelRangeConfig* factionRanges = nullptr;
+    if (IsAlliancePlayerBot(player))
+    {
+        factionRanges = g_AllianceLevelRanges.data();
+    }
+    else if (IsHordePlayerBot(player))
+    {
+        factionRanges = g_HordeLevelRanges.data();
+    }
+    else
+    {
+        return -1; // Unknown faction
+    }
+
+    int targetRange = GetNearestBracketIndex(player->GetLevel(), player->GetTeamId(), player->getClass());
+    if (targetRange >= 0)
+    {
+        ObjectGuid guid = player->GetGUID();
+        if (!g_PendingLevelResets.Contains(guid) && !IsBotResetInProgress(guid) &&
+            flagged.Push({guid, targetRange, factionRanges, static_cast<uint8>(player->GetTeamId())}))
+        {
+            TraceBotDecision(guid, player->GetTeamId(), BRACKET_TRACE_FLAGGED_OUT_OF_RANGE, -1, targetRange);
+        }
+    }
+
+    return -1;
+}
+
+
+// -----------------------------------------------------------------------------
+// DISTRIBUTION SCAN
+// -----------------------------------------------------------------------------
+// A distribution pass collects every random bot into its bracket, then plans the surplus moves
+// for Alliance and Horde. In sliced mode the pass is spread over several world ticks: the bot list
+// is walked in slices through a resumable cursor, each faction is planned on its own tick, and the
+// flags are only committed to g_PendingLevelResets once the whole pass has finished.
+enum DistributionScanPhase : uint8
+{
+    SCAN_PHASE_IDLE = 0,
+    SCAN_PHASE_COLLECT,
+    SCAN_PHASE_PLAN_ALLIANCE,
+    SCAN_PHASE_PLAN_HORDE
+};
+
+struct FactionScanState
+{
+    uint32 totalBots = 0;
+    std::vector<int> actualCounts;
+    std::vector<int> desiredCounts;
+    std::vector< std::vector<ObjectGuid> > botsByRange;
+};
+
+struct DistributionScanState
+{
+    DistributionScanPhase phase = SCAN_PHASE_IDLE;
+    std::vector<ObjectGuid> botGuids;        ///< Random bots online when the pass started
+    size_t cursor = 0;                       ///< Next index into botGuids
+    FactionScanState factions[2];            ///< Indexed by TeamId
+    PendingResetQueue flagged;               ///< Flags raised during the pass, committed at the end
+};
+
+static DistributionScanState g_DistributionScan;
+
+
+/**
+ * @brief Returns whether distribution passes are spread over several world ticks.
+ *
+ * @return true if a slice size or a per-tick time budget is configured, false otherwise.
+ */
+static bool IsDistributionScanSliced()
+{
+    return g_ScanSliceSize > 0 || g_ScanSliceBudgetMs > 0;
+}
+
+
+/**
+ * @brief Drops any distribution pass in progress.
+ *
+ * Called when the configuration is reloaded, since the bracket count or bounds the pass was
+ * collected against may have changed.
+ */
+static void AbortDistributionScan()
+{
+    g_DistributionScan.phase = SCAN_PHASE_IDLE;
+    g_DistributionScan.botGuids.clear();
+    g_DistributionScan.flagged.Clear();
+    g_DistributionScan.cursor = 0;
+}
+
+
+/**
+ * @brief Checks whether a bot is already waiting for a level reset, either in the pending list
+ * among the flags raised by the current distribution pass, or in the middle of a staged reset.
+ *
+ * @param guid The GUID of the bot to look up.
+ * @return true if the bot is already flagged, false otherwise.
+ */
+static bool IsBotFlaggedForReset(ObjectGuid guid)
+{
+    return g_PendingLevelResets.Contains(guid) || g_DistributionScan.flagged.Contains(guid) || IsBotResetInProgress(guid);
+}
+
+
+/**
+ * @brief Starts a new distribution pass.
+ *
+ * Refreshes the real player guild cache, snapshots the GUIDs of the random bots in the census
+ * and resets the per-faction collection state.
+ */
+static void BeginDistributionScan()
+{
+    LoadRealPlayerGuildIds();
+
+    g_DistributionScan.botGuids.clear();
+    g_DistributionScan.botGuids.reserve(g_BotCensusMembers.size());
+    for (const auto& itr : g_BotCensusMembers)
+    {
+        g_DistributionScan.botGuids.push_back(itr.first);
+    }
+    g_DistributionScan.cursor = 0;
+    g_DistributionScan.flagged.Clear();
+
+    for (FactionScanState& state : g_DistributionScan.factions)
+    {
+        state.totalBots = 0;
+        state.actualCounts.assign(g_NumRanges, 0);
+        state.desiredCounts.assign(g_NumRanges, 0);
+        state.botsByRange.assign(g_NumRanges, std::vector<ObjectGuid>());
+    }
+
+    g_DistributionScan.phase = SCAN_PHASE_COLLECT;
+    ++g_Stats.scansStarted;
+    g_Stats.scanStartMSTime = getMSTime();
+    g_Stats.scanWorkMs = 0;
+    g_Stats.scanCollectMicros = 0;
+
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Starting processing of {} random bots.", g_DistributionScan.botGuids.size());
+    }
+}
+
+
+/**
+ * @brief Collects a single bot into the bracket state of its faction.
+ *
+ * Skips players that are gone, not in world, not random bots, excluded, or protected by the guild,
+ * friend list or arena team options. Bots outside every bracket are flagged by GetOrFlagPlayerBracket().
+ *
+ * @param player Pointer to the Player object to collect, may be null.
+ */
+static void CollectBotForDistribution(Player* player)
+{
+    if (!player)
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Skipping null player.");
+        }
+        return;
+    }
+    if (!player->IsInWorld())
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Skipping player '{}' as they are not in world.", player->GetName());
+        }
+        return;
+    }
+    if (!IsPlayerBot(player) || !IsPlayerRandomBot(player))
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Skipping player '{}' as they are not a random bot.", player->GetName());
+        }
+        return;
+    }
+    // Bots grouped with real players still count towards the faction total; GetOrFlagPlayerBracket() skips them.
+    uint8 exclusionReasons = GetBotExclusionReasons(player);
+    if (exclusionReasons & BOT_EXCLUSION_NAME)
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Skipping excluded bot '{}'.", player->GetName());
+        }
+        return;
+    }
+    if (exclusionReasons & (BOT_EXCLUSION_GUILD | BOT_EXCLUSION_FRIEND | BOT_EXCLUSION_ARENA_TEAM))
+    {
+        return;
+    }
+    if (!IsAlliancePlayerBot(player) && !IsHordePlayerBot(player))
+    {
+        return;
+    }
+
+    const char* factionName = IsAlliancePlayerBot(player) ? "Alliance" : "Horde";
+    FactionScanState& state = g_DistributionScan.factions[player->GetTeamId()];
+    state.totalBots++;
+    int rangeIndex = GetOrFlagPlayerBracket(player, g_DistributionScan.flagged);
+    if (rangeIndex >= 0)
+    {
+        state.actualCounts[rangeIndex]++;
+        state.botsByRange[rangeIndex].push_back(player->GetGUID());
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] {} bot '{}' with level {} added to range {}.",
+                     factionName, player->GetName(), player->GetLevel(), rangeIndex + 1);
+        }
+    }
+    else if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] {} bot '{}' with level {} does not fall into any defined range.",
+                 factionName, player->GetName(), player->GetLevel());
+    }
+}
+
+
+/**
+ * @brief Collects the next slice of bots of the current distribution pass.
+ *
+ * When slicing is disabled the whole snapshot is collected at once. Otherwise collection stops
+ * after g_ScanSliceSize bots or once g_ScanSliceBudgetMs has been spent, whichever comes first,
+ * and resumes from the cursor on the next call.
+ *
+ * @return true if every bot of the snapshot has been collected, false if more slices remain.
+ */
+static bool CollectDistributionSlice()
+{
+    bool sliced = IsDistributionScanSliced();
+    uint32 sliceStart = getMSTime();
+    uint32 collected = 0;
+    std::vector<ObjectGuid>& guids = g_DistributionScan.botGuids;
+
+    while (g_DistributionScan.cursor < guids.size())
+    {
+        if (sliced && collected > 0)
+        {
+            if (g_ScanSliceSize > 0 && collected >= g_ScanSliceSize)
+            {
+                break;
+            }
+            if (g_ScanSliceBudgetMs > 0 && GetMSTimeDiffToNow(sliceStart) >= g_ScanSliceBudgetMs)
+            {
+                break;
+            }
+        }
+        CollectBotForDistribution(ObjectAccessor::FindPlayer(guids[g_DistributionScan.cursor++]));
+        ++collected;
+    }
+
+    return g_DistributionScan.cursor >= guids.size();
+}
+
+
+/**
+ * @brief Plans the surplus redistribution of one faction from the collected bracket state.
+ *
+ * Bots that left the world since they were collected are dropped from the counts first. The
+ * desired count of each bracket is then derived from its desiredPercent, and brackets whose surplus
+ * is within g_SurplusDeadband are treated as on target. PlanMinCostRebalance()
+ * decides how many bots move between which brackets, using as few resets as possible and
+ * preferring neighbouring brackets. For each move the bots are picked "safe" bots (those eligible
+ * for immediate reset) first, then by how close their level is to the target bracket.
+ *
+ * @param teamId The faction to plan (TEAM_ALLIANCE or TEAM_HORDE).
+ */
+static void PlanFactionRedistribution(uint8 teamId)
+{
+    FactionScanState& state = g_DistributionScan.factions[teamId];
+    std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+    const char* factionName = (teamId == TEAM_ALLIANCE) ? "Alliance" : "Horde";
+
+    std::vector< std::vector<Player*> > botsByRange(g_NumRanges);
+    for (int i = 0; i < g_NumRanges; ++i)
+    {
+        for (ObjectGuid guid : state.botsByRange[i])
+        {
+            Player* bot = ObjectAccessor::FindPlayer(guid);
+            if (!bot || !bot->IsInWorld())
+            {
+                state.actualCounts[i]--;
+                state.totalBots--;
+                continue;
+            }
+            botsByRange[i].push_back(bot);
+        }
+    }
+
+    if (state.totalBots == 0)
+    {
+        return;
+    }
+
+    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+    }
+    for (int i = 0; i < g_NumRanges; ++i)
+    {
+        state.desiredCounts[i] = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * state.totalBots));
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] {} Range {} ({}-{}): Desired = {}, Actual = {}.",
+                     factionName, i + 1, ranges[i].lower, ranges[i].upper,
+                     state.desiredCounts[i], state.actualCounts[i]);
+        }
+    }
+
+    std::vector<int>& actualCounts = state.actualCounts;
+    std::vector<int>& desiredCounts = state.desiredCounts;
+
+    // Surplus within the deadband is left alone: the planner sees such brackets as on target.
+    std::vector<int> planCounts(actualCounts);
+    for (int i = 0; i < g_NumRanges; ++i)
+    {
+        int surplus = g_SurplusDeadband.ActionableSurplus(actualCounts[i], desiredCounts[i], g_BracketCorrecting[teamId][i]);
+        g_BracketCorrecting[teamId][i] = surplus > 0;
+        if (actualCounts[i] > desiredCounts[i])
+        {
+            planCounts[i] = desiredCounts[i] + surplus;
+            if (surplus == 0 && g_BotDistFullDebugMode)
+            {
+                LOG_INFO("server.loading", "[BotLevelBrackets] {} Range {}: surplus of {} within deadband, left alone.",
+                         factionName, i + 1, actualCounts[i] - desiredCounts[i]);
+            }
+        }
+    }
+
+    // Candidates of overpopulated brackets, by class group since Death Knights cannot go below level 55
+    struct RebalanceCandidate
+    {
+        Player* bot;
+        bool safe;
+    };
+    std::vector<std::array<std::vector<RebalanceCandidate>, MAX_BRACKET_CLASS_GROUPS>> candidates(g_NumRanges);
+    std::vector<std::array<uint32, MAX_BRACKET_CLASS_GROUPS>> movable(g_NumRanges);
+    for (int i = 0; i < g_NumRanges; ++i)
+    {
+        movable[i].fill(0);
+        if (planCounts[i] <= desiredCounts[i])
+        {
+            continue;
+        }
+        for (Player* bot : botsByRange[i])
+        {
+            uint8 group = (bot->getClass() == CLASS_DEATH_KNIGHT) ? BRACKET_CLASS_GROUP_DEATH_KNIGHT : BRACKET_CLASS_GROUP_DEFAULT;
+            candidates[i][group].push_back({ bot, IsBotSafeForLevelReset(bot) });
+            ++movable[i][group];
+        }
+    }
+
+    // --------- Minimum-cost surplus redistribution: fewest resets, shortest moves ----------
+    std::vector<RebalanceMove> moves = PlanMinCostRebalance(ranges, g_NumRanges, planCounts, desiredCounts, movable);
+    // Short moves pick their bots first.
+    std::sort(moves.begin(), moves.end(), [](const RebalanceMove& a, const RebalanceMove& b)
+    {
+        return std::abs(a.from - a.to) < std::abs(b.from - b.to);
+    });
+
+    for (const RebalanceMove& move : moves)
+    {
+        if (g_BotDistFullDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] {} plan: move {} bot(s) from range {} to range {}.",
+                     factionName, move.count, move.from + 1, move.to + 1);
+        }
+
+        // Safe bots first, then the bots whose level is closest to the target bracket.
+        std::vector<RebalanceCandidate>& pool = candidates[move.from][move.group];
+        const LevelRangeConfig& target = ranges[move.to];
+        std::sort(pool.begin(), pool.end(), [&target, &move](const RebalanceCandidate& a, const RebalanceCandidate& b)
+        {
+            if (a.safe != b.safe)
+            {
+                return a.safe;
+            }
+            return GetLevelDistanceToRange(a.bot->GetLevel(), target, move.group) < GetLevelDistanceToRange(b.bot->GetLevel(), target, move.group);
+        });
+
+        uint32 count = std::min<uint32>(move.count, pool.size());
+        for (uint32 k = 0; k < count; ++k)
+        {
+            Player* bot = pool[k].bot;
+            // Only flag if not already flagged
+            if (!IsBotFlaggedForReset(bot->GetGUID()))
+            {
+                g_DistributionScan.flagged.Push({bot->GetGUID(), move.to, ranges.data(), teamId});
+                TraceBotDecision(bot->GetGUID(), teamId, BRACKET_TRACE_FLAGGED_SURPLUS, move.from, move.to);
+                if (g_BotDistFullDebugMode)
+                {
+                    LOG_INFO("server.loading", "[BotLevelBrackets] {} {} '{}' flagged for pending level reset to range {}-{}.",
+                             factionName, pool[k].safe ? "bot" : "flagged bot", bot->GetName(), target.lower, target.upper);
+                }
+            }
+            actualCounts[move.from]--;
+            actualCounts[move.to]++;
+        }
+        pool.erase(pool.begin(), pool.begin() + count);
+    }
+}
+
+
+/**
+ * @brief Commits the flags raised by the finished distribution pass to g_PendingLevelResets.
+ *
+ * Also logs the resulting distribution of both factions when debug logging is enabled.
+ */
+static void CommitDistributionScan()
+{
+    for (const auto& itr : g_DistributionScan.flagged.Entries())
+    {
+        g_PendingLevelResets.Push(itr.second);
+    }
+    ++g_Stats.scansCompleted;
+    g_Stats.lastScanWallMs = GetMSTimeDiffToNow(g_Stats.scanStartMSTime);
+    g_Stats.lastScanBots = g_DistributionScan.factions[TEAM_ALLIANCE].totalBots + g_DistributionScan.factions[TEAM_HORDE].totalBots;
+    g_Stats.lastScanFlagged = g_DistributionScan.flagged.Size();
+    g_Stats.lastScanFinishedAt = static_cast<uint32>(GameTime::GetGameTime().count());
+    g_DistributionScan.flagged.Clear();
+    g_DistributionScan.botGuids.clear();
+
+    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+    {
+        const FactionScanState& alliance = g_DistributionScan.factions[TEAM_ALLIANCE];
+        const FactionScanState& horde = g_DistributionScan.factions[TEAM_HORDE];
+        LOG_INFO("server.loading", "[BotLevelBrackets] ========================================= COMPLETE");
+        LOG_INFO("server.loading", "[BotLevelBrackets] Distribution adjustment complete. Alliance bots: {}, Horde bots: {}.",
+                 alliance.totalBots, horde.totalBots);
+        LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+        for (int i = 0; i < g_NumRanges; ++i)
+        {
+            int desired = static_cast<int>(round((g_AllianceLevelRanges[i].desiredPercent / 100.0) * alliance.totalBots));
+            LOG_INFO("server.loading", "[BotLevelBrackets] Alliance Range {} ({}-{}): Desired = {}, Actual = {}.",
+                     i + 1, g_AllianceLevelRanges[i].lower, g_AllianceLevelRanges[i].upper,
+                     desired, alliance.actualCounts[i]);
+        }
+        LOG_INFO("server.loading", "[BotLevelBrackets] ----------------------------------------");
+        for (int i = 0; i < g_NumRanges; ++i)
+        {
+            int desired = static_cast<int>(round((g_HordeLevelRanges[i].desiredPercent / 100.0) * horde.totalBots));
+            LOG_INFO("server.loading", "[BotLevelBrackets] Horde Range {} ({}-{}): Desired = {}, Actual = {}.",
+                     i + 1, g_HordeLevelRanges[i].lower, g_HordeLevelRanges[i].upper,
+                     desired, horde.actualCounts[i]);
+        }
+        LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+    }
+}
+
+
+/**
+ * @brief Runs the next step of the current distribution pass.
+ *
+ * Without slicing the whole pass (collection, Alliance planning, Horde planning and commit) runs
+ * in this call. With slicing each call does one step: one collection slice, or the planning of one
+ * faction, so Alliance and Horde are planned on different ticks. Does nothing when no pass is running.
+ */
+static void StepDistributionScan()
+{
+    bool sliced = IsDistributionScanSliced();
+    do
+    {
+        switch (g_DistributionScan.phase)
+        {
+            case SCAN_PHASE_IDLE:
+                return;
+            case SCAN_PHASE_COLLECT:
+            {
+                std::chrono::steady_clock::time_point sliceStart = std::chrono::steady_clock::now();
+                bool collected = CollectDistributionSlice();
+                g_Stats.scanCollectMicros += GetMicrosSince(sliceStart);
+                if (!collected)
+                {
+                    return;
+                }
+                g_Stats.phaseMicros[BRACKET_STATS_PHASE_COLLECT] = g_Stats.scanCollectMicros;
+                if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+                {
+                    LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+                    LOG_INFO("server.loading", "[BotLevelBrackets] Total Alliance Bots: {}.", g_DistributionScan.factions[TEAM_ALLIANCE].totalBots);
+                    LOG_INFO("server.loading", "[BotLevelBrackets] Total Horde Bots: {}.", g_DistributionScan.factions[TEAM_HORDE].totalBots);
+                    LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+                }
+                g_DistributionScan.phase = SCAN_PHASE_PLAN_ALLIANCE;
+                break;
+            }
+            case SCAN_PHASE_PLAN_ALLIANCE:
+            {
+                std::chrono::steady_clock::time_point planStart = std::chrono::steady_clock::now();
+                PlanFactionRedistribution(TEAM_ALLIANCE);
+                g_Stats.phaseMicros[BRACKET_STATS_PHASE_PLAN_ALLIANCE] = GetMicrosSince(planStart);
+                g_DistributionScan.phase = SCAN_PHASE_PLAN_HORDE;
+                break;
+            }
+            case SCAN_PHASE_PLAN_HORDE:
+            {
+                std::chrono::steady_clock::time_point planStart = std::chrono::steady_clock::now();
+                PlanFactionRedistribution(TEAM_HORDE);
+                g_Stats.phaseMicros[BRACKET_STATS_PHASE_PLAN_HORDE] = GetMicrosSince(planStart);
+                CommitDistributionScan();
+                g_DistributionScan.phase = SCAN_PHASE_IDLE;
+                return;
+            }
+        }
+    } while (!sliced);
+}
+
+
+/**
+ * @brief Advances the current distribution pass and adds the time spent to the scan statistics.
+ */
+static void AdvanceDistributionScan()
+{
+    if (g_DistributionScan.phase == SCAN_PHASE_IDLE)
+    {
+        return;
+    }
+
+    uint32 stepStart = getMSTime();
+    StepDistributionScan();
+    g_Stats.scanWorkMs += GetMSTimeDiffToNow(stepStart);
+    if (g_DistributionScan.phase == SCAN_PHASE_IDLE)
+    {
+        g_Stats.lastScanWorkMs = g_Stats.scanWorkMs;
+    }
+}
+
+
+/**
+ * @brief Formats one decision trace record as a single line.
+ *
+ * @param record The record.
+ * @param nowMs Current game time in milliseconds, to show the age of the record.
+ * @return std::string e.g. "-12.345s flagged-surplus bot 1234 (Alliance) range 3 -> 5".
+ */
+static std::string FormatTraceRecord(const BracketTraceRecord& record, uint64 nowMs)
+{
+    auto rangeName = [](int16 range) { return range >= 0 ? std::to_string(range + 1) : std::string("-"); };
+    uint64 ageMs = nowMs > record.timeMs ? nowMs - record.timeMs : 0;
+    return Acore::StringFormat("-{}.{:03}s {} bot {} ({}) range {} -> {}",
+                               ageMs / 1000, ageMs % 1000, GetBracketTraceReasonName(record.reason), record.guid,
+                               record.teamId == TEAM_HORDE ? "Horde" : "Alliance", rangeName(record.fromRange), rangeName(record.toRange));
+}
+
+
+/**
+ * @brief Writes the whole decision trace to the log, oldest record first.
+ *
+ * Called on shutdown when BotLevelBrackets.TraceDumpOnShutdown is enabled.
+ */
+static void DumpDecisionTraceToLog()
+{
+    uint64 total = g_DecisionTrace.GetTotal();
+    if (total == 0)
+    {
+        return;
+    }
+    uint64 nowMs = GameTime::GetGameTimeMS().count();
+    LOG_INFO("server.loading", "[BotLevelBrackets] Decision trace: {} decisions recorded, last {} follow.",
+             total, std::min<uint64>(total, DECISION_TRACE_CAPACITY));
+    g_DecisionTrace.ForEachRecent(0, [nowMs](const BracketTraceRecord& record)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Trace {}", FormatTraceRecord(record, nowMs));
+    });
+}
+
+
+/**
+ * @brief Writes a snapshot of the module counters into the mapped stats segment.
+ *
+ * Called once per pending reset cycle. The bracket counts come from the census, so the snapshot
+ * costs O(levels + brackets + pending resets) and never walks the player map.
+ */
+static void PublishStatsSegment()
+{
+    BracketStatsPayload payload;
+    std::memset(&payload, 0, sizeof(payload));
+
+    uint64 nowMs = GameTime::GetGameTimeMS().count();
+    uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+    payload.publishedAtMs = nowMs;
+    payload.enabled = g_BotLevelBracketsEnabled ? 1 : 0;
+    payload.numRanges = std::min<uint32>(g_NumRanges, BRACKET_STATS_MAX_RANGES);
+
+    std::vector<int> counts;
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+    {
+        const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+        BracketStatsFaction& faction = payload.factions[teamId];
+        faction.totalBots = GetCensusBracketCounts(teamId, ranges, counts);
+        for (uint32 i = 0; i < payload.numRanges; ++i)
+        {
+            faction.actual[i] = counts[i];
+            faction.desired[i] = static_cast<int32>(round((ranges[i].desiredPercent / 100.0) * faction.totalBots));
+        }
+    }
+    for (const auto& itr : g_PendingLevelResets.Entries())
+    {
+        BracketStatsFaction& faction = payload.factions[itr.second.teamId == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE];
+        ++faction.pendingResets;
+        faction.oldestPendingAgeSec = std::max(faction.oldestPendingAgeSec, now - std::min(now, itr.second.enqueuedAt));
+    }
+
+    payload.resetsDone = g_Stats.resetsDone;
+    payload.resetsDropped = g_Stats.resetsDropped;
+    payload.resetsRateLimited = g_Stats.resetsRateLimited;
+    if (g_StatsPublishedAtMs > 0 && nowMs > g_StatsPublishedAtMs)
+    {
+        payload.resetsPerHour = (g_Stats.resetsDone - g_StatsPublishedResets) * 3600000.0 / (nowMs - g_StatsPublishedAtMs);
+    }
+    g_StatsPublishedResets = g_Stats.resetsDone;
+    g_StatsPublishedAtMs = nowMs;
+
+    payload.scansStarted = g_Stats.scansStarted;
+    payload.scansCompleted = g_Stats.scansCompleted;
+    payload.scansSkipped = g_Stats.scansSkipped;
+    payload.stagedResetsInProgress = static_cast<uint32>(g_StagedBotResets.size());
+    payload.lastScanBots = g_Stats.lastScanBots;
+    payload.lastScanFlagged = g_Stats.lastScanFlagged;
+    payload.lastScanWallMs = g_Stats.lastScanWallMs;
+    std::copy(std::begin(g_Stats.phaseMicros), std::end(g_Stats.phaseMicros), payload.phaseMicros);
+
+    WriteBracketStatsSegment(*g_StatsSegment, payload);
+}
+
+
+// -----------------------------------------------------------------------------
+// LEVEL SAMPLER FOR OTHER MODULES
+// -----------------------------------------------------------------------------
+/**
+ * @brief Returns the census bracket counts of a faction, adjusted for login assignments still pending.
+ *
+ * @param teamId The faction (TEAM_ALLIANCE or TEAM_HORDE).
+ * @param ranges The brackets of that faction.
+ * @param counts Output vector, resized to g_NumRanges, receiving the bot count per bracket.
+ * @return uint32 The total number of random bots of the faction in the census.
+ */
+static uint32 GetLiveBracketCounts(uint8 teamId, const std::vector<LevelRangeConfig>& ranges, std::vector<int>& counts)
+{
+    uint32 total = GetCensusBracketCounts(teamId, ranges, counts);
+    for (const auto& itr : g_PendingLevelResets.Entries())
+    {
+        const PendingResetEntry& entry = itr.second;
+        if (!entry.urgent || entry.teamId != teamId || entry.targetRange < 0 || entry.targetRange >= g_NumRanges)
+        {
+            continue;
+        }
+        if (entry.fromRange >= 0 && entry.fromRange < g_NumRanges)
+        {
+            --counts[entry.fromRange];
+        }
+        ++counts[entry.targetRange];
+    }
+    return total;
+}
+
+
+/**
+ * @brief Picks a level for a new or re-rolled random bot from the brackets short of bots.
+ *
+ * Declared in mod-player-bot-level-brackets.h. Bracket counts come from GetLiveBracketCounts(), and
+ * the bracket is drawn with a probability proportional to its deficit, so a burst of rolls spreads
+ * over the deficits instead of piling into the largest one.
+ */
+uint8 BotLevelBracketsSampleLevel(uint8 teamId, uint8 classId)
+{
+    if (!g_BotLevelBracketsEnabled || (teamId != TEAM_ALLIANCE && teamId != TEAM_HORDE))
+    {
+        return 0;
+    }
+
+    const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+    std::vector<int> counts;
+    uint32 total = GetLiveBracketCounts(teamId, ranges, counts);
+
+    // Desired counts include the bot being rolled.
+    std::vector<int> desired(g_NumRanges);
+    for (uint8 i = 0; i < g_NumRanges; ++i)
+    {
+        desired[i] = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * (total + 1)));
+    }
+
+    uint8 group = (classId == CLASS_DEATH_KNIGHT) ? BRACKET_CLASS_GROUP_DEATH_KNIGHT : BRACKET_CLASS_GROUP_DEFAULT;
+    return SampleDeficitLevel(ranges, g_NumRanges, counts, desired, group, [](uint32 lower, uint32 upper) { return urand(lower, upper); });
+}
+
+
+// -----------------------------------------------------------------------------
+// LOGIN BRACKET ASSIGNMENT
+// -----------------------------------------------------------------------------
+// A random bot that logs in into a surplus bracket, or outside every bracket, is given its target
+// bracket right away instead of playing at its old level until a distribution pass flags it. The
+// bot joins the pending reset queue as an urgent entry, which the next world tick resets ahead of
+// every other entry without waiting for the pending reset check or for the rate limits, through
+// the same count limit, time budget and map thread hand-off as any other flagged bot. Bots
+// logging in meanwhile see the pending assignments in their bracket counts.
+
+/**
+ * @brief Picks the target bracket of a random bot that is logging in.
+ *
+ * Bracket counts come from GetLiveBracketCounts(); the census already includes the bot. A bot in a bracket whose surplus is within the deadband keeps its bracket.
+ * Otherwise the target is the bracket with a deficit closest to the bot's level, or for a bot
+ * outside every bracket with no deficit anywhere, the nearest bracket.
+ *
+ * @param player The random bot.
+ * @return int The target bracket, or -1 if the bot should stay where it is.
+ */
+static int ChooseLoginBracket(Player* player)
+{
+    uint8 teamId = player->GetTeamId() == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+    const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+    std::vector<int> counts;
+    uint32 total = GetLiveBracketCounts(teamId, ranges, counts);
+
+    int fromRange = GetLevelRangeIndex(player->GetLevel(), teamId);
+    if (fromRange >= 0)
+    {
+        int desired = static_cast<int>(round((ranges[fromRange].desiredPercent / 100.0) * total));
+        if (g_SurplusDeadband.ActionableSurplus(counts[fromRange], desired, g_BracketCorrecting[teamId][fromRange]) == 0)
+        {
+            return -1;
+        }
+    }
+
+    uint8 group = (player->getClass() == CLASS_DEATH_KNIGHT) ? BRACKET_CLASS_GROUP_DEATH_KNIGHT : BRACKET_CLASS_GROUP_DEFAULT;
+    int target = -1;
+    int targetDistance = std::numeric_limits<int>::max();
+    for (uint8 i = 0; i < g_NumRanges; ++i)
+    {
+        uint8 lower = 0;
+        uint8 upper = 0;
+        int desired = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * total));
+        if (static_cast<int>(i) == fromRange || counts[i] >= desired || !GetAssignableRange(ranges[i], group, lower, upper))
+        {
+            continue;
+        }
+        int distance = GetLevelDistanceToRange(player->GetLevel(), ranges[i], group);
+        if (distance < targetDistance)
+        {
+            target = i;
+            targetDistance = distance;
+        }
+    }
+
+    if (target < 0 && fromRange < 0)
+    {
+        target = GetNearestBracketIndex(player->GetLevel(), teamId, player->getClass());
+    }
+    return target;
+}
+
+
+/**
+ * @brief Assigns a bracket to a random bot as it logs in, if its current one is over target.
+ *
+ * @param player The player that logged in.
+ */
+static void AssignLoginBracket(Player* player)
+{
+    if (!IsPlayerRandomBot(player) || IsBotFlaggedForReset(player->GetGUID()) || GetBotExclusionReasons(player) != BOT_EXCLUSION_NONE)
+    {
+        return;
+    }
+
+    int toRange = ChooseLoginBracket(player);
+    if (toRange < 0)
+    {
+        return;
+    }
+
+    uint8 teamId = player->GetTeamId() == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+    int fromRange = GetLevelRangeIndex(player->GetLevel(), teamId);
+    const LevelRangeConfig* factionRanges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges.data() : g_HordeLevelRanges.data();
+    PendingResetEntry entry{ player->GetGUID(), toRange, factionRanges, teamId };
+    entry.urgent = true;
+    entry.fromRange = fromRange;
+    g_PendingLevelResets.Push(entry);
+    TraceBotDecision(player->GetGUID(), teamId, BRACKET_TRACE_ASSIGNED_AT_LOGIN, fromRange, toRange);
+
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Bot '{}' ({}) logged in at level {}, assigned to range {}.",
+                 player->GetName(), teamId == TEAM_ALLIANCE ? "Alliance" : "Horde", player->GetLevel(), toRange + 1);
+    }
+}
+
+
+/**
+ * @brief Sends a random bot logging in for the first time to a bracket drawn by BotLevelBracketsSampleLevel().
+ *
+ * A bot that was never played is taken to be new. It gets an urgent reset into the bracket of the
+ * sampled level, so it starts out where its faction is short of bots instead of where its creation
+ * roll put it. Bots already in the drawn bracket are left alone.
+ *
+ * @param player The player that logged in.
+ * @return true if the bot was queued for a reset.
+ */
+static bool AssignNewBotBracket(Player* player)
+{
+    if (player->GetTotalPlayedTime() != 0 || !IsPlayerRandomBot(player) || IsBotFlaggedForReset(player->GetGUID()) ||
+        GetBotExclusionReasons(player) != BOT_EXCLUSION_NONE)
+    {
+        return false;
+    }
+
+    uint8 teamId = player->GetTeamId() == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+    uint8 level = BotLevelBracketsSampleLevel(teamId, player->getClass());
+    int toRange = level ? GetLevelRangeIndex(level, teamId) : -1;
+    int fromRange = GetLevelRangeIndex(player->GetLevel(), teamId);
+    if (toRange < 0 || toRange == fromRange)
+    {
+        return false;
+    }
+
+    const LevelRangeConfig* factionRanges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges.data() : g_HordeLevelRanges.data();
+    PendingResetEntry entry{ player->GetGUID(), toRange, factionRanges, teamId };
+    entry.urgent = true;
+    entry.fromRange = fromRange;
+    g_PendingLevelResets.Push(entry);
+    TraceBotDecision(player->GetGUID(), teamId, BRACKET_TRACE_ASSIGNED_AT_LOGIN, fromRange, toRange);
+
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] New bot '{}' ({}) logged in at level {}, sampled into range {}.",
+                 player->GetName(), teamId == TEAM_ALLIANCE ? "Alliance" : "Horde", player->GetLevel(), toRange + 1);
+    }
+    return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// PERSISTENCE: Pending resets and census across restarts
+// -----------------------------------------------------------------------------
+// Rows per multi-row INSERT when saving the pending resets.
+static constexpr size_t PENDING_RESETS_BATCH_ROWS = 500;
+
+
+/**
+ * @brief Returns the bracket of a faction with the given bounds.
+ *
+ * Saved resets store bracket bounds rather than indices, so a bracket still matches after brackets
+ * were added or removed. If no bracket has these exact bounds, the bracket holding the middle of
+ * the saved range is used.
+ *
+ * @return int The bracket index, or -1 if none fits.
+ */
+static int FindBracketByBounds(uint8 teamId, uint8 lower, uint8 upper)
+{
+    const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+    for (uint8 i = 0; i < g_NumRanges; ++i)
+    {
+        if (ranges[i].lower == lower && ranges[i].upper == upper)
+        {
+            return i;
+        }
+    }
+    return GetLevelRangeIndex(static_cast<uint8>((lower + upper) / 2), teamId);
+}
+
+
+/**
+ * @brief Saves the pending level resets and the per-bracket census to the character database.
+ *
+ * Both tables are rewritten in a single transaction. Resets handed to a map thread are saved with
+ * the pending ones. Flags raised by a distribution pass that is still running are not saved; the
+ * next pass raises them again.
+ *
+ * @param direct Commit synchronously, for saves during shutdown.
+ */
+static void SaveBotLevelBracketsState(bool direct = false)
+{
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+
+    trans->Append("DELETE FROM bot_level_brackets_pending_resets");
+    std::vector<const PendingResetEntry*> entries;
+    entries.reserve(g_PendingLevelResets.Size() + g_MapThreadResetsInFlight.size());
+    for (const auto& itr : g_PendingLevelResets.Entries())
+    {
+        entries.push_back(&itr.second);
+    }
+    for (const auto& itr : g_MapThreadResetsInFlight)
+    {
+        entries.push_back(&itr.second.entry);
+    }
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const PendingResetEntry* entry)
+    {
+        return !entry->factionRanges || entry->targetRange < 0 || entry->targetRange >= g_NumRanges;
+    }), entries.end());
+    for (size_t begin = 0; begin < entries.size(); begin += PENDING_RESETS_BATCH_ROWS)
+    {
+        size_t end = std::min(entries.size(), begin + PENDING_RESETS_BATCH_ROWS);
+        std::ostringstream sql;
+        sql << "INSERT INTO bot_level_brackets_pending_resets (guid, team_id, range_lower, range_upper, enqueued_at) VALUES ";
+        for (size_t i = begin; i < end; ++i)
+        {
+            const PendingResetEntry& entry = *entries[i];
+            const LevelRangeConfig& target = entry.factionRanges[entry.targetRange];
+            sql << (i > begin ? "," : "") << "(" << entry.botGuid.GetCounter() << "," << uint32(entry.teamId) << ","
+                << uint32(target.lower) << "," << uint32(target.upper) << "," << entry.enqueuedAt << ")";
+        }
+        trans->Append(sql.str());
+    }
+
+    trans->Append("DELETE FROM bot_level_brackets_census");
+    std::ostringstream sql;
+    sql << "INSERT INTO bot_level_brackets_census (team_id, range_index, range_lower, range_upper, bot_count, desired_count) VALUES ";
+    std::vector<int> counts;
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+    {
+        const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+        uint32 total = GetCensusBracketCounts(teamId, ranges, counts);
+        for (uint8 i = 0; i < g_NumRanges; ++i)
+        {
+            int desired = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * total));
+            sql << (teamId == TEAM_ALLIANCE && i == 0 ? "" : ",") << "(" << uint32(teamId) << "," << uint32(i) << ","
+                << uint32(ranges[i].lower) << "," << uint32(ranges[i].upper) << "," << counts[i] << "," << desired << ")";
+        }
+    }
+    if (g_NumRanges > 0)
+    {
+        trans->Append(sql.str());
+    }
+
+    if (direct)
+    {
+        CharacterDatabase.DirectCommitTransaction(trans);
+    }
+    else
+    {
+        CharacterDatabase.CommitTransaction(trans);
+    }
+
+    if (g_BotDistFullDebugMode)
+    {
+        LOG_INFO("server.loading", "[BotLevelBrackets] Saved {} pending resets and the bracket census.", entries.size());
+    }
+}
+
+
+/**
+ * @brief Restores the pending level resets and the census saved before the last shutdown.
+ *
+ * Resets are queued again oldest first, keeping their original enqueue time, and kept for
+ * g_RestoreGracePeriod seconds while their bots log back in. The saved census tells, once the live
+ * census has caught up, whether the distribution is still the one the restored resets were planned
+ * against (see CensusMatchesRestored()). Both queries run asynchronously.
+ */
+static void LoadBotLevelBracketsState()
+{
+    g_RestoreGraceUntil = static_cast<uint32>(GameTime::GetGameTime().count()) + g_RestoreGracePeriod;
+
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery(
+        "SELECT guid, team_id, range_lower, range_upper, enqueued_at FROM bot_level_brackets_pending_resets ORDER BY enqueued_at").WithCallback([](QueryResult result)
+    {
+        if (!result)
+        {
+            return;
+        }
+
+        uint32 restored = 0;
+        uint32 skipped = 0;
+        do
+        {
+            Field* fields = result->Fetch();
+            uint8 teamId = fields[1].Get<uint8>() == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+            int targetRange = FindBracketByBounds(teamId, fields[2].Get<uint8>(), fields[3].Get<uint8>());
+            if (targetRange < 0)
+            {
+                ++skipped;
+                continue;
+            }
+
+            PendingResetEntry entry;
+            entry.botGuid = ObjectGuid::Create<HighGuid::Player>(fields[0].Get<uint32>());
+            entry.targetRange = targetRange;
+            entry.factionRanges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges.data() : g_HordeLevelRanges.data();
+            entry.teamId = teamId;
+            entry.enqueuedAt = fields[4].Get<uint32>();
+            if (g_PendingLevelResets.Push(entry))
+            {
+                ++restored;
+            }
+        } while (result->NextRow());
+
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Restored {} pending resets from the last shutdown ({} no longer match a bracket).", restored, skipped);
+        }
+    }));
+
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery(
+        "SELECT team_id, range_lower, range_upper, bot_count FROM bot_level_brackets_census").WithCallback([](QueryResult result)
+    {
+        if (!result)
+        {
+            return;
+        }
+
+        bool bracketsMatch = true;
+        uint32 rows = 0;
+        g_RestoredCensusCounts[TEAM_ALLIANCE].assign(g_NumRanges, 0);
+        g_RestoredCensusCounts[TEAM_HORDE].assign(g_NumRanges, 0);
+        do
+        {
+            Field* fields = result->Fetch();
+            uint8 teamId = fields[0].Get<uint8>() == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+            uint8 lower = fields[1].Get<uint8>();
+            uint8 upper = fields[2].Get<uint8>();
+            uint32 count = fields[3].Get<uint32>();
+            g_RestoredCensusTotal[teamId] += count;
+            ++rows;
+
+            int rangeIndex = FindBracketByBounds(teamId, lower, upper);
+            const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+            if (rangeIndex < 0 || ranges[rangeIndex].lower != lower || ranges[rangeIndex].upper != upper)
+            {
+                bracketsMatch = false;
+                continue;
+            }
+            g_RestoredCensusCounts[teamId][rangeIndex] = static_cast<int>(count);
+        } while (result->NextRow());
+        g_RestoredCensusPending = true;
+
+        if (!bracketsMatch || rows != 2u * g_NumRanges)
+        {
+            g_RestoredCensusCounts[TEAM_ALLIANCE].clear();
+            g_RestoredCensusCounts[TEAM_HORDE].clear();
+        }
+
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] Last census before shutdown: {} Alliance and {} Horde random bots.",
+                     g_RestoredCensusTotal[TEAM_ALLIANCE], g_RestoredCensusTotal[TEAM_HORDE]);
+        }
+    }));
+}
+
+
+/**
+ * @brief Checks whether the live census has caught up with the census saved before the last shutdown.
+ *
+ * @return true once both factions have at least 90% of their saved random bots online again, or
+ *         the restore grace period has run out.
+ */
+static bool CensusCaughtUpWithRestored()
+{
+    if (GameTime::GetGameTime().count() >= g_RestoreGraceUntil)
+    {
+        return true;
+    }
+
+    std::vector<int> counts;
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+    {
+        const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+        uint32 total = GetCensusBracketCounts(teamId, ranges, counts);
+        if (total * 10 < g_RestoredCensusTotal[teamId] * 9)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Checks whether the live census matches, bracket by bracket, the census saved before the last shutdown.
+ *
+ * When it does, the restored pending resets were planned against the current distribution and the
+ * first distribution check can wait for its regular time.
+ *
+ * @return true if no faction's bracket count is off by more than 10% (at least 2 bots) from the
+ *         saved one. False if the brackets changed since the census was saved.
+ */
+static bool CensusMatchesRestored()
+{
+    std::vector<int> counts;
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+    {
+        const std::vector<int>& saved = g_RestoredCensusCounts[teamId];
+        if (saved.size() != g_NumRanges)
+        {
+            return false;
+        }
+        const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+        GetCensusBracketCounts(teamId, ranges, counts);
+        for (uint8 i = 0; i < g_NumRanges; ++i)
+        {
+            if (std::abs(counts[i] - saved[i]) > std::max(2, saved[i] / 10))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// OFFLINE REBALANCING
+// -----------------------------------------------------------------------------
+// Offline random bots are moved between brackets by rewriting their level in the characters table.
+// The level distribution comes from one aggregate query, the planner balances the offline bots among
+// themselves, and the chosen bots are updated in one transaction; every query and
+// write runs on the database worker threads. A moved bot gets its spells, talents and gear
+// regenerated for its new level through the normal pending reset path when it next logs in.
+static constexpr uint32 OFFLINE_REBALANCE_BATCH_ROWS = 500;
+
+// Bots whose level was rewritten offline, or whose staged reset was cut short, and whose loadout
+// still has to be regenerated, by GUID counter.
+static std::unordered_set<ObjectGuid::LowType> g_OfflineRebalancedBots;
+// Set while the queries of an offline run are in flight.
+static bool g_OfflineRebalanceRunning = false;
+
+// Offline random bots per faction, class group and level, from the aggregate query.
+typedef std::array<std::array<std::array<uint32, BRACKET_LEVEL_SLOTS>, MAX_BRACKET_CLASS_GROUPS>, 2> OfflineBotHistogram;
+
+
+/**
+ * @brief Returns the comma-separated list of random bot account IDs, for IN clauses.
+ */
+static std::string GetRandomBotAccountList()
+{
+    std::ostringstream accounts;
+    for (size_t i = 0; i < sPlayerbotAIConfig->randomBotAccounts.size(); ++i)
+    {
+        accounts << (i > 0 ? "," : "") << sPlayerbotAIConfig->randomBotAccounts[i];
+    }
+    return accounts.str();
+}
+
+
+/**
+ * @brief Loads the bots moved offline whose loadout has not been regenerated yet.
+ */
+static void LoadOfflineRebalancedBots()
+{
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery("SELECT guid FROM bot_level_brackets_offline_moves").WithCallback([](QueryResult result)
+    {
+        if (!result)
+        {
+            return;
+        }
+        do
+        {
+            g_OfflineRebalancedBots.insert(result->Fetch()->Get<uint32>());
+        } while (result->NextRow());
+
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+        {
+            LOG_INFO("server.loading", "[BotLevelBrackets] {} bots moved offline are waiting for a loadout refresh.", g_OfflineRebalancedBots.size());
+        }
+    }));
+}
+
+
+/**
+ * @brief Queues the loadout refresh of a bot that was moved while offline.
+ *
+ * Called when a random bot logs in. The bot is flagged for a reset within the bracket its new level
+ * is in, which regenerates its spells, talents and gear like any other level reset. The entry is
+ * urgent, so the bot is reset on the next tick instead of playing with its old loadout meanwhile.
+ *
+ * @param player The player that logged in.
+ */
+static void QueueOfflineRebalancedBotRefresh(Player* player)
+{
+    if (g_OfflineRebalancedBots.erase(player->GetGUID().GetCounter()) == 0)
+    {
+        return;
+    }
+    CharacterDatabase.Execute("DELETE FROM bot_level_brackets_offline_moves WHERE guid = {}", player->GetGUID().GetCounter());
+
+    int rangeIndex = GetLevelRangeIndex(player->GetLevel(), player->GetTeamId());
+    if (rangeIndex < 0 || !IsPlayerRandomBot(player))
+    {
+        return;
+    }
+    const LevelRangeConfig* factionRanges = (player->GetTeamId() == TEAM_ALLIANCE) ? g_AllianceLevelRanges.data() : g_HordeLevelRanges.data();
+    PendingResetEntry entry{ player->GetGUID(), rangeIndex, factionRanges, static_cast<uint8>(player->GetTeamId()) };
+    // A bot already queued keeps its target bracket but no longer waits its turn.
+    if (const PendingResetEntry* queued = g_PendingLevelResets.Find(player->GetGUID()))
+    {
+        entry = *queued;
+        g_PendingLevelResets.Remove(player->GetGUID());
+    }
+    entry.urgent = true;
+    entry.fromRange = rangeIndex;
+    g_PendingLevelResets.Push(entry);
+}
+
+
+/**
+ * @brief Records a bot whose level changed without its loadout being regenerated yet.
+ *
+ * Used for bots that log out or leave the world in the middle of a staged reset. They are refreshed
+ * on their next login like the bots moved offline (see QueueOfflineRebalancedBotRefresh()).
+ *
+ * @param guid The GUID counter of the bot.
+ */
+static void MarkBotForLoadoutRefresh(ObjectGuid::LowType guid)
+{
+    if (g_OfflineRebalancedBots.insert(guid).second)
     {
-        if (ArenaTeam* team = sArenaTeamMgr->GetArenaTeamById(bot->GetArenaTeamId(slot)))
-        {
-            return true;
-        }
+        CharacterDatabase.Execute("INSERT IGNORE INTO bot_level_brackets_offline_moves (guid) VALUES ({})", guid);
     }
-    return false;
 }
 
 
 /**
- * @brief Clamps and balances the level brackets for Alliance and Horde bot distributions.
+ * @brief Picks the offline bots to move from the candidate rows and writes their new levels.
  *
- * This function ensures that the lower and upper bounds of each level bracket for both Alliance and Horde
- * are within the allowed minimum and maximum bot levels. If a bracket's lower bound exceeds its upper bound,
- * its desired percentage is set to zero. After clamping, the function checks if the sum of desired percentages
- * for each faction equals 100. If not, and the total is greater than zero, it auto-adjusts the percentages
- * upwards (one at a time, round-robin) until the sum reaches 100. Debug information is logged if enabled.
+ * Bots excluded by name, friends list, guild or arena team are skipped. Within each surplus
+ * bracket the bots are taken in random order. Levels and the offline move records are written in
+ * one transaction, and only for bots that are still offline when it runs. The set of bots waiting
+ * for a loadout refresh is reloaded from the move records after the commit.
  *
- * Globals used:
- * - g_AllianceLevelRanges: Array of Alliance level brackets.
- * - g_HordeLevelRanges: Array of Horde level brackets.
- * - g_NumRanges: Number of level brackets.
- * - g_RandomBotMinLevel: Minimum allowed bot level.
- * - g_RandomBotMaxLevel: Maximum allowed bot level.
- * - g_BotDistFullDebugMode: Debug mode flag.
+ * @param result Candidate rows: guid, race, class, level, guild id (0 for none).
+ * @param moves The planned moves, per faction.
  */
-static void ClampAndBalanceBrackets()
+static void ApplyOfflineRebalance(QueryResult result, const std::array<std::vector<RebalanceMove>, 2>& moves)
 {
-    for (uint8 i = 0; i < g_NumRanges; ++i)
+    if (!result)
     {
-        if (g_AllianceLevelRanges[i].lower < g_RandomBotMinLevel)
-        {
-            g_AllianceLevelRanges[i].lower = g_RandomBotMinLevel;
-        }
-        if (g_AllianceLevelRanges[i].upper > g_RandomBotMaxLevel)
-        {
-            g_AllianceLevelRanges[i].upper = g_RandomBotMaxLevel;
-        }
-        if (g_AllianceLevelRanges[i].lower > g_AllianceLevelRanges[i].upper)
-        {
-            g_AllianceLevelRanges[i].desiredPercent = 0;
-        }
+        return;
     }
-    for (uint8 i = 0; i < g_NumRanges; ++i)
+
+    // Candidates per faction, bracket and class group.
+    std::array<std::vector<std::array<std::vector<ObjectGuid::LowType>, MAX_BRACKET_CLASS_GROUPS>>, 2> candidates;
+    candidates[TEAM_ALLIANCE].resize(g_NumRanges);
+    candidates[TEAM_HORDE].resize(g_NumRanges);
+    do
     {
-        if (g_HordeLevelRanges[i].lower < g_RandomBotMinLevel)
-        {
-            g_HordeLevelRanges[i].lower = g_RandomBotMinLevel;
-        }
-        if (g_HordeLevelRanges[i].upper > g_RandomBotMaxLevel)
+        Field* fields = result->Fetch();
+        ObjectGuid::LowType guid = fields[0].Get<uint32>();
+        uint8 teamId = Player::TeamIdForRace(fields[1].Get<uint8>()) == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+        uint8 group = fields[2].Get<uint8>() == CLASS_DEATH_KNIGHT ? BRACKET_CLASS_GROUP_DEATH_KNIGHT : BRACKET_CLASS_GROUP_DEFAULT;
+        int rangeIndex = GetLevelRangeIndex(fields[3].Get<uint8>(), teamId);
+        uint32 guildId = fields[4].Get<uint32>();
+        // The query only sees the guild tracker table; guilds seen with real players since its last update are checked here.
+        bool realPlayerGuild = g_IgnoreGuildBotsWithRealPlayers && guildId != 0 &&
+                               (g_RealPlayerGuildIds.count(guildId) > 0 || g_PersistentRealPlayerGuildIds.count(guildId) > 0);
+        if (rangeIndex < 0 || realPlayerGuild || g_ExcludeBotGuids.count(guid) || g_OfflineRebalancedBots.count(guid) ||
+            (g_IgnoreFriendListed && g_SocialFriendRefs.count(guid)))
         {
-            g_HordeLevelRanges[i].upper = g_RandomBotMaxLevel;
+            continue;
         }
-        if (g_HordeLevelRanges[i].lower > g_HordeLevelRanges[i].upper)
+        candidates[teamId][rangeIndex][group].push_back(guid);
+    } while (result->NextRow());
+
+    std::vector<std::pair<ObjectGuid::LowType, uint8>> newLevels;
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+    {
+        const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+        for (const RebalanceMove& move : moves[teamId])
         {
-            g_HordeLevelRanges[i].desiredPercent = 0;
+            uint8 lower = 0;
+            uint8 upper = 0;
+            if (move.from >= g_NumRanges || move.to >= g_NumRanges || !GetAssignableRange(ranges[move.to], move.group, lower, upper))
+            {
+                continue;
+            }
+            std::vector<ObjectGuid::LowType>& pool = candidates[teamId][move.from][move.group];
+            for (uint32 k = 0; k < move.count && !pool.empty(); ++k)
+            {
+                size_t pick = urand(0, pool.size() - 1);
+                newLevels.emplace_back(pool[pick], static_cast<uint8>(urand(lower, upper)));
+                pool[pick] = pool.back();
+                pool.pop_back();
+            }
         }
     }
-    uint32 totalAlliance = 0;
-    uint32 totalHorde = 0;
-    for (uint8 i = 0; i < g_NumRanges; ++i)
+
+    if (newLevels.empty())
     {
-        totalAlliance += g_AllianceLevelRanges[i].desiredPercent;
-        totalHorde += g_HordeLevelRanges[i].desiredPercent;
+        return;
     }
-    if (totalAlliance != 100 && totalAlliance > 0)
+
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    for (size_t begin = 0; begin < newLevels.size(); begin += OFFLINE_REBALANCE_BATCH_ROWS)
     {
-        if (g_BotDistFullDebugMode)
-        {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Alliance: Sum of percentages is {} (expected 100). Auto adjusting.", totalAlliance);
-        }
-        int missing = 100 - totalAlliance;
-        while (missing > 0)
+        size_t end = std::min(newLevels.size(), begin + OFFLINE_REBALANCE_BATCH_ROWS);
+        std::ostringstream update;
+        std::ostringstream guids;
+        update << "UPDATE characters SET xp = 0, level = CASE guid";
+        for (size_t i = begin; i < end; ++i)
         {
-            for (uint8 i = 0; i < g_NumRanges && missing > 0; ++i)
-            {
-                if (g_AllianceLevelRanges[i].lower <= g_AllianceLevelRanges[i].upper && g_AllianceLevelRanges[i].desiredPercent > 0)
-                {
-                    g_AllianceLevelRanges[i].desiredPercent++;
-                    missing--;
-                }
-            }
+            update << " WHEN " << newLevels[i].first << " THEN " << uint32(newLevels[i].second);
+            guids << (i > begin ? "," : "") << newLevels[i].first;
         }
+        update << " END WHERE online = 0 AND guid IN (" << guids.str() << ")";
+        trans->Append(update.str());
+        trans->Append("INSERT IGNORE INTO bot_level_brackets_offline_moves (guid) SELECT guid FROM characters WHERE online = 0 AND guid IN (" + guids.str() + ")");
     }
-    if (totalHorde != 100 && totalHorde > 0)
+
+    // Bots that logged in before the transaction ran are skipped by the SQL, so the in-memory set
+    // is refilled from the move records once the commit has completed.
+    size_t planned = newLevels.size();
+    g_TransactionProcessor.AddCallback(CharacterDatabase.AsyncCommitTransaction(trans)).AfterComplete([planned](bool success)
     {
-        if (g_BotDistFullDebugMode)
+        if (!success)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Horde: Sum of percentages is {} (expected 100). Auto adjusting.", totalHorde);
+            LOG_ERROR("server.loading", "[BotLevelBrackets] Offline rebalancing failed to write the levels of {} offline bots.", planned);
+            return;
         }
-        int missing = 100 - totalHorde;
-        while (missing > 0)
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
         {
-            for (uint8 i = 0; i < g_NumRanges && missing > 0; ++i)
-            {
-                if (g_HordeLevelRanges[i].lower <= g_HordeLevelRanges[i].upper && g_HordeLevelRanges[i].desiredPercent > 0)
-                {
-                    g_HordeLevelRanges[i].desiredPercent++;
-                    missing--;
-                }
-            }
+            LOG_INFO("server.loading", "[BotLevelBrackets] Offline rebalancing wrote the levels of up to {} offline bots.", planned);
         }
-    }
+        LoadOfflineRebalancedBots();
+    });
 }
 
 
 /**
- * @brief Checks if a bot is in a safe state to perform a level reset.
- *
- * This function verifies several conditions to ensure that the provided bot is safe for a level reset operation.
- * The checks include:
- * - The bot pointer and its session are valid and not in the process of logging out or being removed from the world.
- * - The bot is currently in the world and alive.
- * - The bot is not in combat.
- * - The bot is not in a battleground, arena, random dungeon, or battleground queue.
- * - The bot is not in flight.
- * - If the bot is in a group, all group members must also be bots.
+ * @brief Plans the offline moves from the aggregate level distribution and queries the candidates.
  *
- * If any of these conditions are not met, the function returns false. If debugging is enabled via
- * g_BotDistFullDebugMode, detailed log messages are generated for each failure case.
+ * The offline bots are balanced among themselves: desired counts are taken over the offline random
+ * bots only, as the distribution check does over the online ones, so each population is steered to
+ * the same percentages and neither pass undoes the other's moves. The surplus deadband applies as
+ * for online bots. At most
+ * g_OfflineRebalanceMaxBots bots are moved per run, shortest moves first.
  *
- * @param bot Pointer to the Player object representing the bot.
- * @return true if the bot is safe for level reset, false otherwise.
+ * @param offline Offline random bots per faction, class group and level.
+ * @param accounts The random bot account list used by the aggregate query.
  */
-static bool IsBotSafeForLevelReset(Player* bot)
+static void PlanOfflineRebalance(const OfflineBotHistogram& offline, const std::string& accounts)
 {
-    if (!bot || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
+    std::array<std::vector<RebalanceMove>, 2> moves;
+    uint32 budget = g_OfflineRebalanceMaxBots > 0 ? g_OfflineRebalanceMaxBots : std::numeric_limits<uint32>::max();
+    std::ostringstream levelFilter;
+    bool anySurplus = false;
+
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
     {
-        if (g_BotDistFullDebugMode)
+        const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+        std::vector<int> actual(g_NumRanges, 0);
+        uint32 total = 0;
+        std::vector<std::array<uint32, MAX_BRACKET_CLASS_GROUPS>> movable(g_NumRanges);
+        for (uint8 i = 0; i < g_NumRanges; ++i)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Null bot pointer provided.");
+            movable[i].fill(0);
+            if (ranges[i].lower > ranges[i].upper)
+            {
+                continue;
+            }
+            for (uint8 group = 0; group < MAX_BRACKET_CLASS_GROUPS; ++group)
+            {
+                for (uint32 level = ranges[i].lower; level <= ranges[i].upper; ++level)
+                {
+                    movable[i][group] += offline[teamId][group][level];
+                }
+                actual[i] += movable[i][group];
+            }
         }
-        return false;
-    }
-    if (!bot->IsInWorld())
-    {
-        if (g_BotDistFullDebugMode)
+        for (uint8 group = 0; group < MAX_BRACKET_CLASS_GROUPS; ++group)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is not in world.", bot->GetName(), bot->GetLevel());
+            for (uint32 level = 0; level < BRACKET_LEVEL_SLOTS; ++level)
+            {
+                total += offline[teamId][group][level];
+            }
         }
-        return false;
-    }
-    if (!bot->IsAlive())
-    {
-        if (g_BotDistFullDebugMode)
+        if (total == 0)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is not alive.", bot->GetName(), bot->GetLevel());
+            continue;
         }
-        return false;
-    }
-    if (bot->IsInCombat())
-    {
-        if (g_BotDistFullDebugMode)
+
+        std::vector<int> desired(g_NumRanges);
+        std::vector<int> planCounts(actual);
+        for (uint8 i = 0; i < g_NumRanges; ++i)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is in combat.", bot->GetName(), bot->GetLevel());
+            desired[i] = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * total));
+            if (actual[i] > desired[i])
+            {
+                planCounts[i] = desired[i] + g_SurplusDeadband.ActionableSurplus(actual[i], desired[i], false);
+            }
+            if (planCounts[i] <= desired[i])
+            {
+                movable[i].fill(0);
+            }
         }
-        return false;
-    }
-    if (bot->InBattleground() || bot->InArena() || bot->inRandomLfgDungeon() || bot->InBattlegroundQueue())
-    {
-        if (g_BotDistFullDebugMode)
+
+        moves[teamId] = PlanMinCostRebalance(ranges, g_NumRanges, planCounts, desired, movable);
+        std::sort(moves[teamId].begin(), moves[teamId].end(), [](const RebalanceMove& a, const RebalanceMove& b)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is in battleground, arena, random dungeon, or battleground queue.", bot->GetName(), bot->GetLevel());
-        }
-        return false;
-    }
-    if (bot->IsInFlight())
-    {
-        if (g_BotDistFullDebugMode)
+            return std::abs(a.from - a.to) < std::abs(b.from - b.to);
+        });
+        for (RebalanceMove& move : moves[teamId])
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) is in flight.", bot->GetName(), bot->GetLevel());
+            move.count = std::min(move.count, budget);
+            budget -= move.count;
+            if (move.count > 0)
+            {
+                levelFilter << (anySurplus ? " OR " : "") << "level BETWEEN " << uint32(ranges[move.from].lower) << " AND " << uint32(ranges[move.from].upper);
+                anySurplus = true;
+            }
         }
-        return false;
     }
-    if (Group* group = bot->GetGroup())
+
+    if (!anySurplus)
     {
-        for (GroupReference* ref = group->GetFirstMember(); ref; ref = ref->next())
+        g_OfflineRebalanceRunning = false;
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
         {
-            Player* member = ref->GetSource();
-            if (member && member->IsInWorld() && !IsPlayerBot(member))
-            {
-                if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Bot {} (Level {}) has non-bot group member {} (Level {}).", bot->GetName(), bot->GetLevel(), member->GetName(), member->GetLevel());
-                }
-                return false;
-            }
+            LOG_INFO("server.loading", "[BotLevelBrackets] Offline rebalancing: no offline bot needs to move.");
         }
+        return;
     }
-    return true;
-}
 
-/**
- * @brief Checks if a given bot is in the exclusion list for bracket processing.
- *
- * This function determines whether the provided bot's name matches any entry in the global
- * exclusion list `g_ExcludeBotNames`, which is populated from the BotLevelBrackets.ExcludeNames config.
- * If a match is found, this bot will not be considered for any bracket checks or level resets.
- *
- * @param bot Pointer to the Player object representing the bot to check.
- * @return true if the bot is excluded from bracket processing, false otherwise.
- */
-static bool IsBotExcluded(Player* bot)
-{
-    if (!bot)
+    std::ostringstream sql;
+    sql << "SELECT guid, race, class, level, IFNULL((SELECT gm.guildid FROM guild_member gm WHERE gm.guid = characters.guid), 0) FROM characters WHERE online = 0 AND account IN (" << accounts << ") AND (" << levelFilter.str() << ")";
+    if (g_IgnoreGuildBotsWithRealPlayers)
     {
-        return false;
+        sql << " AND guid NOT IN (SELECT gm.guid FROM guild_member gm JOIN bot_level_brackets_guild_tracker gt ON gt.guild_id = gm.guildid WHERE gt.has_real_players = 1)";
     }
-    const std::string& name = bot->GetName();
-    for (const auto& excluded : g_ExcludeBotNames)
+    if (g_IgnoreArenaTeamBots)
     {
-        if (excluded == name)
-        {
-            return true;
-        }
+        sql << " AND guid NOT IN (SELECT guid FROM arena_team_member)";
     }
-    return false;
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery(sql.str()).WithCallback([moves](QueryResult result)
+    {
+        ApplyOfflineRebalance(result, moves);
+        g_OfflineRebalanceRunning = false;
+    }));
 }
 
+
 /**
- * @brief Processes the pending level reset requests for player bots.
- *
- * This function iterates through the global list of pending level resets (`g_PendingLevelResets`)
- * and attempts to reset the level of each eligible bot to a specified range. The function enforces
- * a configurable limit (`g_FlaggedProcessLimit`) on the number of resets processed per cycle.
- *
- * Bots are skipped and removed from the pending list if:
- *   - The bot is not found or not in the world.
- *   - The bot's session is invalid, logging out, or being removed from the world.
- *   - The bot is in a guild with real players and `g_IgnoreGuildBotsWithRealPlayers` is enabled.
- *   - The bot is in a friend list and `g_IgnoreFriendListed` is enabled.
- *
- * If a bot is eligible and safe for a level reset, its level is adjusted to the target range using
- * `AdjustBotToRange`. Debug information is logged if `g_BotDistFullDebugMode` is enabled.
+ * @brief Starts an offline rebalancing run with the aggregate level distribution query.
  *
- * The function returns immediately if there are no pending resets.
+ * Does nothing while a previous run is still in flight or when no random bot accounts are known.
  */
-static void ProcessPendingLevelResets()
+static void StartOfflineRebalance()
 {
-    if (g_BotDistFullDebugMode)
-    {
-        LOG_INFO("server.loading", "[BotLevelBrackets] Processing {} pending resets...", g_PendingLevelResets.size());
-    }
-    if (g_PendingLevelResets.empty())
+    if (g_OfflineRebalanceRunning || sPlayerbotAIConfig->randomBotAccounts.empty())
     {
         return;
     }
+    g_OfflineRebalanceRunning = true;
 
-    // Limit the number of resets processed in one cycle if configured.
-    uint32 processed = 0;
-    for (auto it = g_PendingLevelResets.begin(); it != g_PendingLevelResets.end(); )
+    std::string accounts = GetRandomBotAccountList();
+    std::string sql = "SELECT race, class, level, COUNT(*) FROM characters WHERE online = 0 AND account IN (" + accounts + ") GROUP BY race, class, level";
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery(sql).WithCallback([accounts](QueryResult result)
+    {
+        if (!result)
         {
-            if (g_FlaggedProcessLimit > 0 && processed >= g_FlaggedProcessLimit)
-                break;
+            g_OfflineRebalanceRunning = false;
+            return;
+        }
 
-            Player* bot = ObjectAccessor::FindPlayer(it->botGuid);
-            
-            if (!bot)
-            {
-                it = g_PendingLevelResets.erase(it);
-                continue;
-            }
+        OfflineBotHistogram offline = {};
+        do
+        {
+            Field* fields = result->Fetch();
+            uint8 teamId = Player::TeamIdForRace(fields[0].Get<uint8>()) == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+            uint8 group = fields[1].Get<uint8>() == CLASS_DEATH_KNIGHT ? BRACKET_CLASS_GROUP_DEATH_KNIGHT : BRACKET_CLASS_GROUP_DEFAULT;
+            offline[teamId][group][fields[2].Get<uint8>()] += static_cast<uint32>(fields[3].Get<uint64>());
+        } while (result->NextRow());
+
+        PlanOfflineRebalance(offline, accounts);
+    }));
+}
 
-            if (!bot->IsInWorld() || !bot->GetSession() || bot->GetSession()->isLogingOut() || bot->IsDuringRemoveFromWorld())
-            {
-                it = g_PendingLevelResets.erase(it);
-                continue;
-            }
 
-            if (IsBotExcluded(bot))
-            {
-                it = g_PendingLevelResets.erase(it);
-                continue;
-            }
+// -----------------------------------------------------------------------------
+// HOURLY PROFILES
+// -----------------------------------------------------------------------------
+// With BotLevelBrackets.Dynamic.Profile.Enabled, every dynamic distribution check records the real
+// players per bracket into the profile of the current hour of the day. During quiet hours the
+// dynamic weights are computed from the profile of the next busy hour instead of the current
+// players, so bots are moved over the quiet hours, when the world thread has time to spare, and
+// are already in place when the players arrive.
 
-            int targetRange = it->targetRange;
-            if (g_IgnoreGuildBotsWithRealPlayers && BotInGuildWithRealPlayer(bot))
-            {
-                it = g_PendingLevelResets.erase(it);
-                continue;
-            }
+// Rows per multi-row statement when saving the hourly profiles.
+static constexpr size_t HOURLY_PROFILE_BATCH_ROWS = 500;
 
-            if (g_IgnoreFriendListed && BotInFriendList(bot))
-            {
-                it = g_PendingLevelResets.erase(it);
-                continue;
-            }
 
-            if (g_IgnoreArenaTeamBots && BotInArenaTeam(bot))
-            {
-                it = g_PendingLevelResets.erase(it);
-                continue;
-            }
+/**
+ * @brief Returns how many dynamic distribution checks fall into one hour.
+ */
+static uint32 GetProfileSamplesPerHour()
+{
+    return std::max<uint32>(1, 3600 / std::max<uint32>(g_BotDistCheckFrequency, 1));
+}
 
-            // Check if bot is now in a group with real players
-            if (Group* group = bot->GetGroup())
-            {
-                bool hasRealPlayer = false;
-                for (GroupReference* ref = group->GetFirstMember(); ref; ref = ref->next())
-                {
-                    Player* member = ref->GetSource();
-                    if (member && member->IsInWorld() && !IsPlayerBot(member))
-                    {
-                        hasRealPlayer = true;
-                        break;
-                    }
-                }
-                if (hasRealPlayer)
-                {
-                    it = g_PendingLevelResets.erase(it);
-                    continue;
-                }
-            }
 
-            if (bot && bot->IsInWorld() && IsBotSafeForLevelReset(bot))
-            {
-                AdjustBotToRange(bot, targetRange, it->factionRanges);
-                if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Bot '{}' successfully reset to level range {}-{}.", bot->GetName(), it->factionRanges[targetRange].lower, it->factionRanges[targetRange].upper);
-                }
-                it = g_PendingLevelResets.erase(it);
-                ++processed;
-            }
-            else
-            {
-                ++it;
-            }
-        }
+/**
+ * @brief Records the real players per bracket of both factions into the profile of an hour.
+ *
+ * @param hour The current hour of the day.
+ * @param realCounts Real players per bracket, indexed by TeamId.
+ */
+static void LearnHourlyProfiles(uint8 hour, const std::vector<int> (&realCounts)[2])
+{
+    uint32 window = g_ProfileMemoryDays * GetProfileSamplesPerHour();
+    g_HourlyProfiles[TEAM_ALLIANCE].AddSample(hour, realCounts[TEAM_ALLIANCE], window);
+    g_HourlyProfiles[TEAM_HORDE].AddSample(hour, realCounts[TEAM_HORDE], window);
 }
 
 
 /**
- * @brief Determines the level bracket index for a given player or flags the player for a level reset if not in any bracket.
+ * @brief During a quiet hour, moves the real player counts the dynamic weights are computed from
+ * towards the profile of the next busy hour.
  *
- * This function attempts to find the appropriate level range (bracket) for the specified player based on their level and faction.
- * If the player is not currently within any defined bracket, the function finds the closest bracket and flags the player for a level reset,
- * ensuring that each player is only flagged once. The function returns the index of the bracket if found, or -1 if the player is not in any bracket.
+ * The counts move by 1 / (hours until the busy hour) of the way, so the targets, and the bots with
+ * them, shift step by step over the quiet hours and reach the busy profile an hour ahead. Hours are
+ * only used once they hold a full hour of samples. Outside quiet hours the counts are left alone.
  *
- * @param player Pointer to the Player object whose bracket is to be determined.
- * @return int The index of the level bracket if found, otherwise -1.
+ * @param hour The current hour of the day.
+ * @param allianceCounts Alliance real players per bracket; updated in place.
+ * @param hordeCounts Horde real players per bracket; updated in place.
  */
-static int GetOrFlagPlayerBracket(Player* player)
+static void PositionForBusyHour(uint8 hour, std::vector<float>& allianceCounts, std::vector<float>& hordeCounts)
 {
-    if (IsPlayerBot(player) && IsBotExcluded(player))
+    uint32 minSamples = GetProfileSamplesPerHour();
+    std::array<float, PROFILE_HOURS> totals;
+    for (uint8 h = 0; h < PROFILE_HOURS; ++h)
     {
-        return -1;
+        bool learned = g_HourlyProfiles[TEAM_ALLIANCE].GetSamples(h) >= minSamples &&
+                       g_HourlyProfiles[TEAM_HORDE].GetSamples(h) >= minSamples;
+        totals[h] = learned ? g_HourlyProfiles[TEAM_ALLIANCE].GetTotal(h) + g_HourlyProfiles[TEAM_HORDE].GetTotal(h) : -1.0f;
+    }
+
+    int hoursAhead = GetHoursUntilBusy(totals, hour, g_ProfileQuietPercent);
+    if (hoursAhead <= 0)
+    {
+        return;
     }
 
-    if (IsPlayerBot(player) && g_IgnoreGuildBotsWithRealPlayers && BotInGuildWithRealPlayer(player))
+    uint8 busyHour = static_cast<uint8>((hour + hoursAhead) % PROFILE_HOURS);
+    float step = 1.0f / hoursAhead;
+    const std::vector<float>& allianceExpected = g_HourlyProfiles[TEAM_ALLIANCE].GetCounts(busyHour);
+    const std::vector<float>& hordeExpected = g_HourlyProfiles[TEAM_HORDE].GetCounts(busyHour);
+    for (size_t i = 0; i < allianceCounts.size() && i < allianceExpected.size(); ++i)
     {
-        return -1;
+        allianceCounts[i] += step * (allianceExpected[i] - allianceCounts[i]);
+    }
+    for (size_t i = 0; i < hordeCounts.size() && i < hordeExpected.size(); ++i)
+    {
+        hordeCounts[i] += step * (hordeExpected[i] - hordeCounts[i]);
     }
 
-    if (IsPlayerBot(player) && g_IgnoreArenaTeamBots && BotInArenaTeam(player))
+    if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
     {
-        return -1;
+        LOG_INFO("server.loading", "[BotLevelBrackets] Quiet hour {}: positioning bots for hour {} ({} expected real players, {} hours ahead).",
+                 hour, busyHour, totals[busyHour], hoursAhead);
     }
+}
+
+
+/**
+ * @brief Saves the hourly profiles of both factions to the character database in one transaction.
+ *
+ * @param direct Commit synchronously, for saves during shutdown.
+ */
+static void SaveHourlyProfiles(bool direct = false)
+{
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    trans->Append("DELETE FROM bot_level_brackets_hourly_profile");
 
-    // Check if bot is in a group with real players - if so, exclude from bracket processing
-    if (IsPlayerBot(player))
+    struct ProfileRow
     {
-        if (Group* group = player->GetGroup())
+        uint8 teamId;
+        uint8 hour;
+        uint8 range;
+    };
+    std::vector<ProfileRow> rows;
+    for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+    {
+        for (uint8 hour = 0; hour < PROFILE_HOURS; ++hour)
         {
-            for (GroupReference* ref = group->GetFirstMember(); ref; ref = ref->next())
+            if (g_HourlyProfiles[teamId].GetSamples(hour) == 0)
             {
-                Player* member = ref->GetSource();
-                if (member && member->IsInWorld() && !IsPlayerBot(member))
-                {
-                    if (g_BotDistFullDebugMode)
-                    {
-                        LOG_INFO("server.loading", "[BotLevelBrackets] GetOrFlagPlayerBracket: Bot {} (Level {}) is in group with real player {} - excluding from bracket processing.", 
-                                 player->GetName(), player->GetLevel(), member->GetName());
-                    }
-                    return -1;
-                }
+                continue;
+            }
+            for (uint8 i = 0; i < g_HourlyProfiles[teamId].GetCounts(hour).size() && i < g_NumRanges; ++i)
+            {
+                rows.push_back({teamId, hour, i});
             }
         }
     }
-
-    int rangeIndex = GetLevelRangeIndex(player->GetLevel(), player->GetTeamId());
-    if (rangeIndex >= 0)
+    for (size_t begin = 0; begin < rows.size(); begin += HOURLY_PROFILE_BATCH_ROWS)
     {
-        return rangeIndex;
+        size_t end = std::min(rows.size(), begin + HOURLY_PROFILE_BATCH_ROWS);
+        std::ostringstream sql;
+        sql << "INSERT INTO bot_level_brackets_hourly_profile (team_id, hour, range_lower, range_upper, real_players, samples) VALUES ";
+        for (size_t i = begin; i < end; ++i)
+        {
+            const ProfileRow& row = rows[i];
+            const LevelRangeConfig& range = (row.teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges[row.range] : g_HordeLevelRanges[row.range];
+            const BracketHourlyProfile& profile = g_HourlyProfiles[row.teamId];
+            sql << (i > begin ? "," : "") << "(" << uint32(row.teamId) << "," << uint32(row.hour) << ","
+                << uint32(range.lower) << "," << uint32(range.upper) << "," << profile.GetCounts(row.hour)[row.range] << ","
+                << profile.GetSamples(row.hour) << ")";
+        }
+        trans->Append(sql.str());
     }
 
-    LevelRangeConfig* factionRanges = nullptr;
-    if (IsAlliancePlayerBot(player))
-    {
-        factionRanges = g_AllianceLevelRanges.data();
-    }
-    else if (IsHordePlayerBot(player))
+    if (direct)
     {
-        factionRanges = g_HordeLevelRanges.data();
+        CharacterDatabase.DirectCommitTransaction(trans);
     }
     else
     {
-        return -1; // Unknown faction
+        CharacterDatabase.CommitTransaction(trans);
     }
+}
 
-    int targetRange = -1;
-    int smallestDiff = std::numeric_limits<int>::max();
-    for (int i = 0; i < g_NumRanges; ++i)
+
+/**
+ * @brief Restores the hourly profiles saved before the last shutdown. Runs asynchronously.
+ *
+ * Rows of brackets whose bounds changed since are skipped.
+ */
+static void LoadHourlyProfiles()
+{
+    g_QueryProcessor.AddCallback(CharacterDatabase.AsyncQuery(
+        "SELECT team_id, hour, range_lower, range_upper, real_players, samples FROM bot_level_brackets_hourly_profile").WithCallback([](QueryResult result)
     {
-        if (factionRanges[i].lower > factionRanges[i].upper)
-        {
-            continue;
-        }
-        
-        // Skip brackets that Death Knights cannot be assigned to (upper bound < 55)
-        if (player->getClass() == CLASS_DEATH_KNIGHT && factionRanges[i].upper < 55)
-        {
-            continue;
-        }
-        
-        int diff = 0;
-        if (player->GetLevel() < factionRanges[i].lower)
-        {
-            diff = factionRanges[i].lower - player->GetLevel();
-        }
-        else if (player->GetLevel() > factionRanges[i].upper)
-        {
-            diff = player->GetLevel() - factionRanges[i].upper;
-        }
-        if (diff < smallestDiff)
+        if (!result)
         {
-            smallestDiff = diff;
-            targetRange = i;
+            return;
         }
-    }
 
-    if (targetRange >= 0)
-    {
-        bool alreadyFlagged = false;
-        ObjectGuid guid = player->GetGUID();
-        for (const auto &entry : g_PendingLevelResets)
+        uint32 restored = 0;
+        do
         {
-            if (entry.botGuid == guid)
+            Field* fields = result->Fetch();
+            uint8 teamId = fields[0].Get<uint8>() == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE;
+            uint8 hour = fields[1].Get<uint8>();
+            uint8 lower = fields[2].Get<uint8>();
+            uint8 upper = fields[3].Get<uint8>();
+            const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+            int range = FindBracketByBounds(teamId, lower, upper);
+            if (hour >= PROFILE_HOURS || range < 0 || ranges[range].lower != lower || ranges[range].upper != upper)
             {
-                alreadyFlagged = true;
-                break;
+                continue;
             }
-        }
-        if (!alreadyFlagged)
+            g_HourlyProfiles[teamId].Restore(hour, static_cast<uint8>(range), fields[4].Get<float>(), fields[5].Get<uint32>());
+            ++restored;
+        } while (result->NextRow());
+
+        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
         {
-            g_PendingLevelResets.push_back({guid, targetRange, factionRanges});
+            LOG_INFO("server.loading", "[BotLevelBrackets] Restored {} hourly profile entries.", restored);
         }
-    }
-
-    return -1;
+    }));
 }
 
 
@@ -1247,7 +4423,49 @@ static int GetOrFlagPlayerBracket(Player* player)
 class BotLevelBracketsWorldScript : public WorldScript
 {
 public:
-    BotLevelBracketsWorldScript() : WorldScript("BotLevelBracketsWorldScript"), m_timer(0), m_flaggedTimer(0), m_guildTrackerTimer(0) { }
+    BotLevelBracketsWorldScript() : WorldScript("BotLevelBracketsWorldScript"), m_timer(0), m_flaggedTimer(0), m_guildTrackerTimer(0), m_persistTimer(0), m_offlineRebalanceTimer(0) { }
+
+    /**
+     * @brief Saves the pending resets and the census when a shutdown or restart is scheduled.
+     *
+     * The countdown can last minutes, so OnShutdown() saves again at the actual stop. This save
+     * stands if the bots were logged out before that, since logging out removes a bot from the queue.
+     */
+    void OnShutdownInitiate(ShutdownExitCode /*code*/, ShutdownMask /*mask*/) override
+    {
+        if (g_BotLevelBracketsEnabled && g_PersistFrequency > 0)
+        {
+            SaveBotLevelBracketsState();
+            if (g_ProfileEnabled)
+            {
+                SaveHourlyProfiles();
+            }
+        }
+    }
+
+    /**
+     * @brief Saves the state changed during the shutdown countdown, dumps the decision trace and
+     *        unmaps the stats segment.
+     *
+     * The saves commit synchronously, as the database is closed soon after. An empty census means
+     * the bots are already logged out, and the earlier save is kept instead.
+     */
+    void OnShutdown() override
+    {
+        if (g_BotLevelBracketsEnabled && g_PersistFrequency > 0 && !g_BotCensusMembers.empty())
+        {
+            SaveBotLevelBracketsState(true);
+            if (g_ProfileEnabled)
+            {
+                SaveHourlyProfiles(true);
+            }
+        }
+        if (g_TraceDumpOnShutdown)
+        {
+            DumpDecisionTraceToLog();
+        }
+        CloseStatsSegment();
+    }
 
     /**
      * @brief Called when the module is started up.
@@ -1263,11 +4481,21 @@ public:
         LoadBotLevelBracketsConfig();
         LoadSocialFriendList();
         LoadPersistentGuildTracker();
+        RebuildCensus();
         if (!g_BotLevelBracketsEnabled)
         {
             LOG_INFO("server.loading", "[BotLevelBrackets] Module disabled via configuration.");
             return;
         }
+        if (g_PersistFrequency > 0)
+        {
+            LoadBotLevelBracketsState();
+            if (g_ProfileEnabled)
+            {
+                LoadHourlyProfiles();
+            }
+        }
+        LoadOfflineRebalancedBots();
         if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
         {
             LOG_INFO("server.loading", "[BotLevelBrackets] Module loaded. Check frequency: {} seconds, Check flagged frequency: {}.", g_BotDistCheckFrequency, g_BotDistFlaggedCheckFrequency);
@@ -1292,15 +4520,12 @@ public:
      * - Checking if the bot level bracket system is enabled.
      * - Managing timers for regular and flagged bot checks.
      * - Processing pending level resets for bots flagged for redistribution.
-     * - Gathering all players and updating guild and friend list caches.
      * - If dynamic distribution is enabled, recalculates the desired percentage of bots per level bracket
      *   based on the current distribution of real players, optionally syncing between factions.
-     * - For each faction (Alliance and Horde):
-     *   - Counts the actual number of bots in each level bracket.
-     *   - Determines the desired number of bots per bracket based on the calculated percentages.
-     *   - Identifies surplus bots in overpopulated brackets and flags them for level reset to underpopulated brackets,
-     *     prioritizing "safe" bots (those eligible for immediate reset) and then flagged bots.
-     *   - Updates internal counts to reflect pending redistributions.
+     * - Checking the live census for surplus brackets and returning early when there are none.
+     * - Starting a distribution pass (see BeginDistributionScan()), which collects the random bots per bracket
+     *   and plans the surplus redistribution of each faction. When ScanSliceSize or ScanSliceBudgetMs is set,
+     *   the pass is advanced a step per tick until it completes.
      * - Provides detailed debug logging if enabled, including before and after distributions.
      *
      * The function ensures that the distribution of player bots across level brackets remains balanced
@@ -1310,6 +4535,30 @@ public:
      */
     void OnUpdate(uint32 diff) override
     {
+        g_QueryProcessor.ProcessReadyCallbacks();
+        g_TransactionProcessor.ProcessReadyCallbacks();
+
+        // Level changes and group or guild changes seen on the map threads during the previous tick.
+        ProcessCensusLevelChanges();
+        ProcessEligibilityInvalidations();
+
+        // Friend list changes are drained while the module is disabled too, so they cannot pile up.
+        ProcessSocialFriendEvents();
+
+        // Resets run by the map threads during the previous tick, even if the module was disabled since.
+        if (!g_MapThreadResetsInFlight.empty())
+        {
+            CollectMapThreadResets();
+        }
+
+        // Staged level resets advance a few stages on every tick, and finish even if the module was disabled since.
+        if (!g_StagedBotResetOrder.empty())
+        {
+            std::chrono::steady_clock::time_point stagedStart = std::chrono::steady_clock::now();
+            ProcessStagedBotResets();
+            g_Stats.phaseMicros[BRACKET_STATS_PHASE_STAGED_RESETS] = GetMicrosSince(stagedStart);
+        }
+
         if (!g_BotLevelBracketsEnabled)
         {
             return;
@@ -1318,6 +4567,8 @@ public:
         m_timer += diff;
         m_flaggedTimer += diff;
         m_guildTrackerTimer += diff;
+        m_persistTimer += diff;
+        m_offlineRebalanceTimer += diff;
 
         if (m_flaggedTimer >= g_BotDistFlaggedCheckFrequency * 1000)
         {
@@ -1325,8 +4576,22 @@ public:
             {
                 LOG_INFO("server.loading", "[BotLevelBrackets] Pending Level Resets Triggering.");
             }
+            std::chrono::steady_clock::time_point pendingStart = std::chrono::steady_clock::now();
             ProcessPendingLevelResets();
+            g_Stats.phaseMicros[BRACKET_STATS_PHASE_PENDING_RESETS] = GetMicrosSince(pendingStart);
             m_flaggedTimer = 0;
+
+            if (g_StatsSegment)
+            {
+                PublishStatsSegment();
+            }
+        }
+        else if (g_PendingLevelResets.UrgentCount() > 0)
+        {
+            // Bots assigned a bracket at login do not wait for the next check.
+            std::chrono::steady_clock::time_point pendingStart = std::chrono::steady_clock::now();
+            ProcessPendingLevelResets(true);
+            g_Stats.phaseMicros[BRACKET_STATS_PHASE_PENDING_RESETS] = GetMicrosSince(pendingStart);
         }
 
         if (m_guildTrackerTimer >= g_GuildTrackerUpdateFrequency * 1000)
@@ -1339,511 +4604,196 @@ public:
             m_guildTrackerTimer = 0;
         }
 
-        if (m_timer < g_BotDistCheckFrequency * 1000)
-        {
-            return;
-        }
-        m_timer = 0;
-
-        const auto& allPlayers = ObjectAccessor::GetPlayers();
-
-        LoadRealPlayerGuildIds(allPlayers);
-
-        LoadSocialFriendList();
-
-        if (g_UseDynamicDistribution)
+        if (g_PersistFrequency > 0 && m_persistTimer >= g_PersistFrequency * 1000)
         {
-            // Calculate real player bracket counts
-            std::vector<int> allianceRealCounts(g_NumRanges, 0);
-            std::vector<int> hordeRealCounts(g_NumRanges, 0);
-            uint32 totalAllianceReal = 0;
-            uint32 totalHordeReal = 0;
-
-            for (auto const& itr : allPlayers)
-            {
-                Player* player = itr.second;
-                if (!player || !player->IsInWorld())
-                    continue;
-                if (IsPlayerBot(player))
-                    continue; // Only count real players.
-                int rangeIndex = GetOrFlagPlayerBracket(player);
-                if (rangeIndex < 0)
-                    continue;
-                if (player->GetTeamId() == TEAM_ALLIANCE)
-                {
-                    allianceRealCounts[rangeIndex]++;
-                    totalAllianceReal++;
-                }
-                else if (player->GetTeamId() == TEAM_HORDE)
-                {
-                    hordeRealCounts[rangeIndex]++;
-                    totalHordeReal++;
-                }
-            }
-
-            const float baseline = 1.0f;
-            std::vector<float> allianceWeights(g_NumRanges, 0.0f);
-            std::vector<float> hordeWeights(g_NumRanges, 0.0f);
-
-            // SYNCED MODE: Real player weighting is combined for both factions, applied to both bracket tables.
-            if (g_SyncFactions)
-            {
-                uint32 totalCombinedReal = totalAllianceReal + totalHordeReal;
-                for (int i = 0; i < g_NumRanges; ++i)
-                {
-                    int combinedReal = allianceRealCounts[i] + hordeRealCounts[i];
-                    float weight = baseline + g_RealPlayerWeight *
-                        (totalCombinedReal > 0 ? (1.0f / float(totalCombinedReal)) : 1.0f) *
-                        log(1 + combinedReal);
-                    allianceWeights[i] = weight;
-                    hordeWeights[i] = weight;
-                }
-            }
-            else
-            {
-                // Separate dynamic weighting for each faction
-                for (int i = 0; i < g_NumRanges; ++i)
-                {
-                    if (g_AllianceLevelRanges[i].lower > g_AllianceLevelRanges[i].upper)
-                        allianceWeights[i] = 0.0f;
-                    else
-                        allianceWeights[i] = baseline + g_RealPlayerWeight *
-                            (totalAllianceReal > 0 ? (1.0f / totalAllianceReal) : 1.0f) *
-                            log(1 + allianceRealCounts[i]);
-
-                    if (g_HordeLevelRanges[i].lower > g_HordeLevelRanges[i].upper)
-                        hordeWeights[i] = 0.0f;
-                    else
-                        hordeWeights[i] = baseline + g_RealPlayerWeight *
-                            (totalHordeReal > 0 ? (1.0f / totalHordeReal) : 1.0f) *
-                            log(1 + hordeRealCounts[i]);
-                }
-            }
-
-            // Helper for normalizing weights so percentages sum to 100
-            auto applyWeights = [](std::vector<LevelRangeConfig>& ranges, const std::vector<float>& weights)
-            {
-                float total = 0.0f;
-                for (int i = 0; i < g_NumRanges; ++i)
-                    total += weights[i];
-                int pctSum = 0;
-                for (int i = 0; i < g_NumRanges; ++i)
-                {
-                    uint8 pct = (total > 0.0f) ? static_cast<uint8>(round((weights[i] / total) * 100)) : 0;
-                    ranges[i].desiredPercent = pct;
-                    pctSum += pct;
-                }
-                // Fix rounding drift so sum = 100
-                int missing = 100 - pctSum;
-                for (int i = 0; i < g_NumRanges && missing > 0; ++i)
-                {
-                    if (ranges[i].lower <= ranges[i].upper && ranges[i].desiredPercent > 0)
-                    {
-                        ranges[i].desiredPercent++;
-                        missing--;
-                    }
-                }
-            };
-
-            applyWeights(g_AllianceLevelRanges, allianceWeights);
-            applyWeights(g_HordeLevelRanges, hordeWeights);
-
-            // Ensure brackets respect global min/max levels and percentages sum to 100
-            ClampAndBalanceBrackets();
-
-            // Debug output for new bracket percentages after normalization
-            if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+            SaveBotLevelBracketsState();
+            if (g_ProfileEnabled)
             {
-                for (int i = 0; i < g_NumRanges; ++i)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Final Range {}: {}-{}, Alliance Desired: {}%, Horde Desired: {}%",
-                        i + 1,
-                        g_AllianceLevelRanges[i].lower,
-                        g_AllianceLevelRanges[i].upper,
-                        g_AllianceLevelRanges[i].desiredPercent,
-                        g_HordeLevelRanges[i].desiredPercent);
-                }
+                SaveHourlyProfiles();
             }
+            m_persistTimer = 0;
         }
-        
-        uint32 totalAllianceBots = 0;
-        std::vector<int> allianceActualCounts(g_NumRanges, 0);
-        std::vector< std::vector<Player*> > allianceBotsByRange(g_NumRanges);
 
-        uint32 totalHordeBots = 0;
-        std::vector<int> hordeActualCounts(g_NumRanges, 0);
-        std::vector< std::vector<Player*> > hordeBotsByRange(g_NumRanges);
+        if (g_OfflineRebalance && m_offlineRebalanceTimer >= g_OfflineRebalanceFrequency * 1000)
+        {
+            StartOfflineRebalance();
+            m_offlineRebalanceTimer = 0;
+        }
 
-        if (g_BotDistFullDebugMode)
+        // A sliced distribution pass picks up where it left off on every tick.
+        if (g_DistributionScan.phase != SCAN_PHASE_IDLE)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] Starting processing of {} players.", allPlayers.size());
+            AdvanceDistributionScan();
         }
 
-        for (auto const& itr : allPlayers)
+        // After a restart, the restored resets carry on where they left off. Only a distribution that
+        // changed while the server was down is rescanned as soon as the bots are back.
+        if (g_RestoredCensusPending && CensusCaughtUpWithRestored())
         {
-            Player* player = itr.second;
-            if (!player)
-            {
-                if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Skipping null player.");
-                }
-                continue;
-            }
-            if (!player->IsInWorld())
-            {
-                if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Skipping player '{}' as they are not in world.", player->GetName());
-                }
-                continue;
-            }
-            if (!IsPlayerBot(player) || !IsPlayerRandomBot(player))
-            {
-                if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Skipping player '{}' as they are not a random bot.", player->GetName());
-                }
-                continue;
-            }
-            if (IsBotExcluded(player))
-            {
-                if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Skipping excluded bot '{}'.", player->GetName());
-                }
-                continue;
-            }
-            if (g_IgnoreGuildBotsWithRealPlayers && BotInGuildWithRealPlayer(player))
-            {
-                continue;
-            }
-            if (g_IgnoreFriendListed && BotInFriendList(player))
-            {
-                continue;
-            }
-            if (g_IgnoreArenaTeamBots && BotInArenaTeam(player))
-            {
-                continue;
-            }
-            if (IsAlliancePlayerBot(player))
-            {
-                totalAllianceBots++;
-                int rangeIndex = GetOrFlagPlayerBracket(player);
-                if (rangeIndex >= 0)
-                {
-                    allianceActualCounts[rangeIndex]++;
-                    allianceBotsByRange[rangeIndex].push_back(player);
-                    if (g_BotDistFullDebugMode)
-                    {
-                        LOG_INFO("server.loading", "[BotLevelBrackets] Alliance bot '{}' with level {} added to range {}.", 
-                                 player->GetName(), player->GetLevel(), rangeIndex + 1);
-                    }
-                }
-                else if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Alliance bot '{}' with level {} does not fall into any defined range.", player->GetName(), player->GetLevel());
-                }
-            }
-            else if (IsHordePlayerBot(player))
+            g_RestoredCensusPending = false;
+            if (!CensusMatchesRestored())
             {
-                totalHordeBots++;
-                int rangeIndex = GetOrFlagPlayerBracket(player);
-                if (rangeIndex >= 0)
-                {
-                    hordeActualCounts[rangeIndex]++;
-                    hordeBotsByRange[rangeIndex].push_back(player);
-                    if (g_BotDistFullDebugMode)
-                    {
-                        LOG_INFO("server.loading", "[BotLevelBrackets] Horde bot '{}' with level {} added to range {}.", 
-                                 player->GetName(), player->GetLevel(), rangeIndex + 1);
-                    }
-                }
-                else if (g_BotDistFullDebugMode)
-                {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Horde bot '{}' with level {} does not fall into any defined range.", player->GetName(), player->GetLevel());
-                }
+                m_timer = g_BotDistCheckFrequency * 1000;
+            }
+            else if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+            {
+                LOG_INFO("server.loading", "[BotLevelBrackets] Census matches the one saved before shutdown; resuming the restored resets without an early check.");
             }
         }
 
-        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+        if (m_timer < g_BotDistCheckFrequency * 1000)
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
-            LOG_INFO("server.loading", "[BotLevelBrackets] Total Alliance Bots: {}.", totalAllianceBots);
-            LOG_INFO("server.loading", "[BotLevelBrackets] Total Horde Bots: {}.", totalHordeBots);
-            LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+            return;
         }
+        m_timer = 0;
 
-        // Process Alliance bots.
-        if (totalAllianceBots > 0)
+        if (g_DistributionScan.phase != SCAN_PHASE_IDLE)
         {
             if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
             {
-                LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+                LOG_INFO("server.loading", "[BotLevelBrackets] Previous distribution scan still in progress. Skipping this check.");
             }
-            std::vector<int> allianceDesiredCounts(g_NumRanges, 0);
-            for (int i = 0; i < g_NumRanges; ++i)
+            return;
+        }
+
+        if (g_UseDynamicDistribution)
+        {
+            // Calculate real player bracket counts
+            std::vector<int> realCounts[2] = { std::vector<int>(g_NumRanges, 0), std::vector<int>(g_NumRanges, 0) };
+            for (Player* player : GetOnlineRealPlayers())
             {
-                allianceDesiredCounts[i] = static_cast<int>(round((g_AllianceLevelRanges[i].desiredPercent / 100.0) * totalAllianceBots));
-                if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+                int rangeIndex = GetLevelRangeIndex(player->GetLevel(), player->GetTeamId());
+                if (rangeIndex < 0)
+                    continue;
+                if (player->GetTeamId() == TEAM_ALLIANCE || player->GetTeamId() == TEAM_HORDE)
                 {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Alliance Range {} ({}-{}): Desired = {}, Actual = {}.", 
-                            i + 1, g_AllianceLevelRanges[i].lower, g_AllianceLevelRanges[i].upper,
-                            allianceDesiredCounts[i], allianceActualCounts[i]);
+                    realCounts[player->GetTeamId()][rangeIndex]++;
                 }
             }
 
+            // Smooth the counts, so a few logins or logouts between checks do not swing the targets.
+            uint32 now = GameTime::GetGameTime().count();
+            std::vector<float> allianceRealCounts = g_RealPlayerCounts[TEAM_ALLIANCE].Update(realCounts[TEAM_ALLIANCE], now, g_RealPlayerHalfLife);
+            std::vector<float> hordeRealCounts = g_RealPlayerCounts[TEAM_HORDE].Update(realCounts[TEAM_HORDE], now, g_RealPlayerHalfLife);
+            if (g_ProfileEnabled)
+            {
+                uint8 hour = static_cast<uint8>(Acore::Time::TimeBreakdown(now).tm_hour);
+                LearnHourlyProfiles(hour, realCounts);
+                PositionForBusyHour(hour, allianceRealCounts, hordeRealCounts);
+            }
+            float totalAllianceReal = 0.0f;
+            float totalHordeReal = 0.0f;
             for (int i = 0; i < g_NumRanges; ++i)
             {
-                // Collect safe and flagged bots
-                std::vector<Player*> safeBots;
-                std::vector<Player*> flaggedBots;
-                for (Player* bot : allianceBotsByRange[i])
-                {
-                    if (IsBotSafeForLevelReset(bot)) {
-                        safeBots.push_back(bot);
-                    } else {
-                        flaggedBots.push_back(bot);
-                    }
-                }
-
-                // --------- Efficient surplus redistribution for safeBots ----------
-                // Build a list of target ranges that need bots
-                std::vector<int> targetRanges;
-                for (int j = 0; j < g_NumRanges; ++j)
-                {
-                    if (allianceActualCounts[j] < allianceDesiredCounts[j])
-                        targetRanges.push_back(j);
-                }
-                size_t targetIdx = 0;
-                while (allianceActualCounts[i] > allianceDesiredCounts[i] && !safeBots.empty() && targetIdx < targetRanges.size())
-                {
-                    Player* bot = safeBots.back();
-                    safeBots.pop_back();
-
-                    int targetRange = targetRanges[targetIdx];
-
-                    // Skip if no need (already filled by earlier loop)
-                    if (allianceActualCounts[targetRange] >= allianceDesiredCounts[targetRange])
-                    {
-                        targetIdx++;
-                        continue;
-                    }
-
-                    // Only flag if not already flagged
-                    ObjectGuid botGuid = bot->GetGUID();
-                    bool alreadyFlagged = false;
-                    for (const auto& entry : g_PendingLevelResets)
-                    {
-                        if (entry.botGuid == botGuid)
-                        {
-                            alreadyFlagged = true;
-                            break;
-                        }
-                    }
-                    if (!alreadyFlagged)
-                    {
-                        g_PendingLevelResets.push_back({bot->GetGUID(), targetRange, g_AllianceLevelRanges.data()});
-                        if (g_BotDistFullDebugMode)
-                        {
-                            LOG_INFO("server.loading", "[BotLevelBrackets] Alliance bot '{}' flagged for pending level reset to range {}-{}.", 
-                                bot->GetName(), g_AllianceLevelRanges[targetRange].lower, g_AllianceLevelRanges[targetRange].upper);
-                        }
-                    }
-                    allianceActualCounts[i]--;
-                    allianceActualCounts[targetRange]++;
-                    if (allianceActualCounts[targetRange] >= allianceDesiredCounts[targetRange])
-                        targetIdx++;
-                }
-                // --------- Efficient surplus redistribution for flaggedBots ----------
-                // Reset for flagged bots
-                targetIdx = 0;
-                while (allianceActualCounts[i] > allianceDesiredCounts[i] && !flaggedBots.empty() && targetIdx < targetRanges.size())
+                totalAllianceReal += allianceRealCounts[i];
+                totalHordeReal += hordeRealCounts[i];
+                if (g_BotDistFullDebugMode)
                 {
-                    Player* bot = flaggedBots.back();
-                    flaggedBots.pop_back();
-
-                    int targetRange = targetRanges[targetIdx];
-
-                    if (allianceActualCounts[targetRange] >= allianceDesiredCounts[targetRange])
-                    {
-                        targetIdx++;
-                        continue;
-                    }
-
-                    ObjectGuid botGuid = bot->GetGUID();
-                    bool alreadyFlagged = false;
-                    for (const auto& entry : g_PendingLevelResets)
-                    {
-                        if (entry.botGuid == botGuid)
-                        {
-                            alreadyFlagged = true;
-                            break;
-                        }
-                    }
-                    if (!alreadyFlagged)
-                    {
-                        g_PendingLevelResets.push_back({bot->GetGUID(), targetRange, g_AllianceLevelRanges.data()});
-                        if (g_BotDistFullDebugMode)
-                        {
-                            LOG_INFO("server.loading", "[BotLevelBrackets] Alliance flagged bot '{}' flagged for pending level reset to range {}-{}.", 
-                                bot->GetName(), g_AllianceLevelRanges[targetRange].lower, g_AllianceLevelRanges[targetRange].upper);
-                        }
-                    }
-                    allianceActualCounts[i]--;
-                    allianceActualCounts[targetRange]++;
-                    if (allianceActualCounts[targetRange] >= allianceDesiredCounts[targetRange])
-                        targetIdx++;
+                    LOG_INFO("server.loading", "[BotLevelBrackets] Range {}: real players Alliance {} (weighted as {:.2f}), Horde {} (weighted as {:.2f}).",
+                             i + 1, realCounts[TEAM_ALLIANCE][i], allianceRealCounts[i], realCounts[TEAM_HORDE][i], hordeRealCounts[i]);
                 }
             }
-        }
 
+            const float baseline = 1.0f;
+            std::vector<float> allianceWeights(g_NumRanges, 0.0f);
+            std::vector<float> hordeWeights(g_NumRanges, 0.0f);
 
-        // Process Horde bots.
-        if (totalHordeBots > 0)
-        {
-            if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
-            {
-                LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
-            }
-            std::vector<int> hordeDesiredCounts(g_NumRanges, 0);
-            for (int i = 0; i < g_NumRanges; ++i)
+            // SYNCED MODE: Real player weighting is combined for both factions, applied to both bracket tables.
+            if (g_SyncFactions)
             {
-                hordeDesiredCounts[i] = static_cast<int>(round((g_HordeLevelRanges[i].desiredPercent / 100.0) * totalHordeBots));
-                if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+                float totalCombinedReal = totalAllianceReal + totalHordeReal;
+                for (int i = 0; i < g_NumRanges; ++i)
                 {
-                    LOG_INFO("server.loading", "[BotLevelBrackets] Horde Range {} ({}-{}): Desired = {}, Actual = {}.",
-                            i + 1, g_HordeLevelRanges[i].lower, g_HordeLevelRanges[i].upper,
-                            hordeDesiredCounts[i], hordeActualCounts[i]);
+                    float combinedReal = allianceRealCounts[i] + hordeRealCounts[i];
+                    float weight = baseline + g_RealPlayerWeight *
+                        (totalCombinedReal > 0.0f ? (1.0f / totalCombinedReal) : 1.0f) *
+                        log(1 + combinedReal);
+                    allianceWeights[i] = weight;
+                    hordeWeights[i] = weight;
                 }
             }
-
-            for (int i = 0; i < g_NumRanges; ++i)
+            else
             {
-                std::vector<Player*> safeBots;
-                std::vector<Player*> flaggedBots;
-                for (Player* bot : hordeBotsByRange[i])
+                // Separate dynamic weighting for each faction
+                for (int i = 0; i < g_NumRanges; ++i)
                 {
-                    if (IsBotSafeForLevelReset(bot)) {
-                        safeBots.push_back(bot);
-                    } else {
-                        flaggedBots.push_back(bot);
-                    }
+                    if (g_AllianceLevelRanges[i].lower > g_AllianceLevelRanges[i].upper)
+                        allianceWeights[i] = 0.0f;
+                    else
+                        allianceWeights[i] = baseline + g_RealPlayerWeight *
+                            (totalAllianceReal > 0.0f ? (1.0f / totalAllianceReal) : 1.0f) *
+                            log(1 + allianceRealCounts[i]);
+
+                    if (g_HordeLevelRanges[i].lower > g_HordeLevelRanges[i].upper)
+                        hordeWeights[i] = 0.0f;
+                    else
+                        hordeWeights[i] = baseline + g_RealPlayerWeight *
+                            (totalHordeReal > 0.0f ? (1.0f / totalHordeReal) : 1.0f) *
+                            log(1 + hordeRealCounts[i]);
                 }
+            }
 
-                // Efficient surplus redistribution for safeBots
-                std::vector<int> targetRanges;
-                for (int j = 0; j < g_NumRanges; ++j)
+            // Helper for normalizing weights so percentages sum to 100
+            auto applyWeights = [](std::vector<LevelRangeConfig>& ranges, const std::vector<float>& weights)
+            {
+                float total = 0.0f;
+                for (int i = 0; i < g_NumRanges; ++i)
+                    total += weights[i];
+                int pctSum = 0;
+                for (int i = 0; i < g_NumRanges; ++i)
                 {
-                    if (hordeActualCounts[j] < hordeDesiredCounts[j])
-                        targetRanges.push_back(j);
+                    uint8 pct = (total > 0.0f) ? static_cast<uint8>(round((weights[i] / total) * 100)) : 0;
+                    ranges[i].desiredPercent = pct;
+                    pctSum += pct;
                 }
-                size_t targetIdx = 0;
-                while (hordeActualCounts[i] > hordeDesiredCounts[i] && !safeBots.empty() && targetIdx < targetRanges.size())
+                // Fix rounding drift so sum = 100
+                int missing = 100 - pctSum;
+                for (int i = 0; i < g_NumRanges && missing > 0; ++i)
                 {
-                    Player* bot = safeBots.back();
-                    safeBots.pop_back();
-
-                    int targetRange = targetRanges[targetIdx];
-
-                    if (hordeActualCounts[targetRange] >= hordeDesiredCounts[targetRange])
-                    {
-                        targetIdx++;
-                        continue;
-                    }
-
-                    bool alreadyFlagged = false;
-                    ObjectGuid botGuid = bot->GetGUID();
-                    for (const auto& entry : g_PendingLevelResets)
-                    {
-                        if (entry.botGuid == botGuid)
-                        {
-                            alreadyFlagged = true;
-                            break;
-                        }
-                    }
-                    if (!alreadyFlagged)
+                    if (ranges[i].lower <= ranges[i].upper && ranges[i].desiredPercent > 0)
                     {
-                        g_PendingLevelResets.push_back({bot->GetGUID(), targetRange, g_HordeLevelRanges.data()});
-                        if (g_BotDistFullDebugMode)
-                        {
-                            LOG_INFO("server.loading", "[BotLevelBrackets] Horde bot '{}' flagged for pending level reset to range {}-{}.", 
-                                bot->GetName(), g_HordeLevelRanges[targetRange].lower, g_HordeLevelRanges[targetRange].upper);
-                        }
+                        ranges[i].desiredPercent++;
+                        missing--;
                     }
-                    hordeActualCounts[i]--;
-                    hordeActualCounts[targetRange]++;
-                    if (hordeActualCounts[targetRange] >= hordeDesiredCounts[targetRange])
-                        targetIdx++;
                 }
-                // Efficient surplus redistribution for flaggedBots
-                targetIdx = 0;
-                while (hordeActualCounts[i] > hordeDesiredCounts[i] && !flaggedBots.empty() && targetIdx < targetRanges.size())
-                {
-                    Player* bot = flaggedBots.back();
-                    flaggedBots.pop_back();
+            };
 
-                    int targetRange = targetRanges[targetIdx];
+            applyWeights(g_AllianceLevelRanges, allianceWeights);
+            applyWeights(g_HordeLevelRanges, hordeWeights);
 
-                    if (hordeActualCounts[targetRange] >= hordeDesiredCounts[targetRange])
-                    {
-                        targetIdx++;
-                        continue;
-                    }
+            // Ensure brackets respect global min/max levels and percentages sum to 100
+            ClampAndBalanceBrackets();
+            RebuildBracketLookupTables();
 
-                    bool alreadyFlagged = false;
-                    ObjectGuid botGuid = bot->GetGUID();
-                    for (const auto& entry : g_PendingLevelResets)
-                    {
-                        if (entry.botGuid == botGuid)
-                        {
-                            alreadyFlagged = true;
-                            break;
-                        }
-                    }
-                    if (!alreadyFlagged)
-                    {
-                        g_PendingLevelResets.push_back({bot->GetGUID(), targetRange, g_HordeLevelRanges.data()});
-                        if (g_BotDistFullDebugMode)
-                        {
-                            LOG_INFO("server.loading", "[BotLevelBrackets] Horde flagged bot '{}' flagged for pending level reset to range {}-{}.", 
-                                bot->GetName(), g_HordeLevelRanges[targetRange].lower, g_HordeLevelRanges[targetRange].upper);
-                        }
-                    }
-                    hordeActualCounts[i]--;
-                    hordeActualCounts[targetRange]++;
-                    if (hordeActualCounts[targetRange] >= hordeDesiredCounts[targetRange])
-                        targetIdx++;
+            // Debug output for new bracket percentages after normalization
+            if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+            {
+                for (int i = 0; i < g_NumRanges; ++i)
+                {
+                    LOG_INFO("server.loading", "[BotLevelBrackets] Final Range {}: {}-{}, Alliance Desired: {}%, Horde Desired: {}%",
+                        i + 1,
+                        g_AllianceLevelRanges[i].lower,
+                        g_AllianceLevelRanges[i].upper,
+                        g_AllianceLevelRanges[i].desiredPercent,
+                        g_HordeLevelRanges[i].desiredPercent);
                 }
             }
         }
 
-
-        if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
+        // The census answers "is anything off?" without touching a single player. Only walk the
+        // player map to pick bots when some bracket is over target or some bot is outside all brackets.
+        if (!CensusShowsImbalance())
         {
-            LOG_INFO("server.loading", "[BotLevelBrackets] ========================================= COMPLETE");
-            LOG_INFO("server.loading", "[BotLevelBrackets] Distribution adjustment complete. Alliance bots: {}, Horde bots: {}.",
-                     totalAllianceBots, totalHordeBots);
-            LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
-            std::vector<int> allianceDesiredCounts(g_NumRanges, 0);
-            for (int i = 0; i < g_NumRanges; ++i)
-            {
-                allianceDesiredCounts[i] = static_cast<int>(round((g_AllianceLevelRanges[i].desiredPercent / 100.0) * totalAllianceBots));
-                LOG_INFO("server.loading", "[BotLevelBrackets] Alliance Range {} ({}-{}): Desired = {}, Actual = {}.", 
-                         i + 1, g_AllianceLevelRanges[i].lower, g_AllianceLevelRanges[i].upper,
-                         allianceDesiredCounts[i], allianceActualCounts[i]);
-            }
-            LOG_INFO("server.loading", "[BotLevelBrackets] ----------------------------------------");
-            std::vector<int> hordeDesiredCounts(g_NumRanges, 0);
-            for (int i = 0; i < g_NumRanges; ++i)
+            if (g_BotDistFullDebugMode || g_BotDistLiteDebugMode)
             {
-                hordeDesiredCounts[i] = static_cast<int>(round((g_HordeLevelRanges[i].desiredPercent / 100.0) * totalHordeBots));
-                LOG_INFO("server.loading", "[BotLevelBrackets] Horde Range {} ({}-{}): Desired = {}, Actual = {}.",
-                         i + 1, g_HordeLevelRanges[i].lower, g_HordeLevelRanges[i].upper,
-                         hordeDesiredCounts[i], hordeActualCounts[i]);
+                LOG_INFO("server.loading", "[BotLevelBrackets] Census shows no surplus bracket. Skipping distribution scan.");
             }
-            LOG_INFO("server.loading", "[BotLevelBrackets] =========================================");
+            ++g_Stats.scansSkipped;
+            return;
         }
+
+        BeginDistributionScan();
+        AdvanceDistributionScan();
     }
 
     /**
@@ -1869,6 +4819,8 @@ private:
     uint32 m_timer;         // For distribution adjustments
     uint32 m_flaggedTimer;  // For pending reset checks
     uint32 m_guildTrackerTimer; // For guild tracker updates
+    uint32 m_persistTimer;  // For saving pending resets and the census
+    uint32 m_offlineRebalanceTimer; // For offline rebalancing runs
 };
 
 
@@ -1876,9 +4828,9 @@ private:
  * @class BotLevelBracketsPlayerScript
  * @brief Handles player-specific logic for the Player Bot Level Brackets module.
  *
- * This script is attached to player events and is responsible for managing
- * bot-related state when a player logs out. Specifically, it ensures that
- * any bot associated with the player is removed from pending reset operations.
+ * This script is attached to player events and keeps the live census current on login,
+ * logout and level changes. On logout it also ensures that any bot associated with the
+ * player is removed from pending reset operations.
  *
  * @see PlayerScript
  */
@@ -1887,9 +4839,177 @@ class BotLevelBracketsPlayerScript : public PlayerScript
 public:
     BotLevelBracketsPlayerScript() : PlayerScript("BotLevelBracketsPlayerScript") {}
 
-    void OnPlayerLogout(Player* player)
+    void OnPlayerLogin(Player* player) override
+    {
+        ResolveExcludedBotName(player);
+        CensusAddPlayer(player);
+        QueueOfflineRebalancedBotRefresh(player);
+        if (g_BotLevelBracketsEnabled)
+        {
+            bool sampled = g_SampleNewBotLevels && AssignNewBotBracket(player);
+            if (!sampled && g_LoginBracketAssignment)
+            {
+                AssignLoginBracket(player);
+            }
+        }
+        // A real player coming back changes what their group mates are allowed to do.
+        InvalidateBotEligibility(player->GetGUID().GetCounter());
+        InvalidateGroupEligibility(player->GetGroup());
+    }
+
+    void OnPlayerLogout(Player* player) override
     {
         RemoveBotFromPendingResets(player);
+        if (IsBotResetInProgress(player->GetGUID()))
+        {
+            ++g_Stats.resetsDropped;
+            TraceBotDecision(player->GetGUID(), player->GetTeamId(), BRACKET_TRACE_STAGED_CANCELLED, -1, -1);
+            CancelStagedBotReset(player->GetGUID());
+            CancelMapThreadReset(player->GetGUID());
+        }
+        CensusRemovePlayer(player);
+        InvalidateBotEligibility(player->GetGUID().GetCounter());
+        InvalidateGroupEligibility(player->GetGroup());
+    }
+
+    // Fires on the map update threads too, so the census is updated on the next world tick.
+    void OnPlayerLevelChanged(Player* player, uint8 /*oldLevel*/) override
+    {
+        QueueCensusLevelChange(player);
+    }
+};
+
+/**
+ * @class BotLevelBracketsMapScript
+ * @brief Runs level resets handed to a map from that map's update, on the map update threads.
+ *
+ * @see AllMapScript
+ */
+class BotLevelBracketsMapScript : public AllMapScript
+{
+public:
+    BotLevelBracketsMapScript() : AllMapScript("BotLevelBracketsMapScript") {}
+
+    void OnMapUpdate(Map* map, uint32 /*diff*/) override
+    {
+        RunMapThreadResets(map);
+    }
+};
+
+/**
+ * @class BotLevelBracketsGuildScript
+ * @brief Drops the cached eligibility of characters joining or leaving a guild.
+ *
+ * The hooks can fire on the map update threads, so the invalidations are queued for the world thread.
+ *
+ * @see GuildScript
+ */
+class BotLevelBracketsGuildScript : public GuildScript
+{
+public:
+    BotLevelBracketsGuildScript() : GuildScript("BotLevelBracketsGuildScript") {}
+
+    void OnAddMember(Guild* /*guild*/, Player* player, uint8& /*plRank*/) override
+    {
+        if (player)
+        {
+            QueueBotEligibilityInvalidation(player->GetGUID().GetCounter());
+        }
+    }
+
+    void OnRemoveMember(Guild* /*guild*/, Player* player, bool /*isDisbanding*/, bool /*isKicked*/) override
+    {
+        if (player)
+        {
+            QueueBotEligibilityInvalidation(player->GetGUID().GetCounter());
+        }
+    }
+};
+
+/**
+ * @class BotLevelBracketsGroupScript
+ * @brief Drops the cached eligibility of group members when the group changes.
+ *
+ * The hooks can fire on the map update threads, so the invalidations are queued for the world thread.
+ *
+ * @see GroupScript
+ */
+class BotLevelBracketsGroupScript : public GroupScript
+{
+public:
+    BotLevelBracketsGroupScript() : GroupScript("BotLevelBracketsGroupScript") {}
+
+    void OnAddMember(Group* group, ObjectGuid guid) override
+    {
+        QueueBotEligibilityInvalidation(guid.GetCounter());
+        QueueGroupEligibilityInvalidation(group);
+    }
+
+    void OnRemoveMember(Group* group, ObjectGuid guid, RemoveMethod /*method*/, ObjectGuid /*kicker*/, char const* /*reason*/) override
+    {
+        QueueBotEligibilityInvalidation(guid.GetCounter());
+        QueueGroupEligibilityInvalidation(group);
+    }
+
+    // The group is gone by the next world tick, so its former members cannot be looked up then.
+    void OnDisband(Group* /*group*/) override
+    {
+        g_InvalidateAllEligibility = true;
+    }
+};
+
+/**
+ * @class BotLevelBracketsServerScript
+ * @brief Watches friend list packets to keep the friend index current.
+ *
+ * Packets arrive on the network threads, so they are only decoded and queued here;
+ * ProcessSocialFriendEvents() applies them on the world thread.
+ *
+ * @see ServerScript
+ */
+class BotLevelBracketsServerScript : public ServerScript
+{
+public:
+    BotLevelBracketsServerScript() : ServerScript("BotLevelBracketsServerScript") {}
+
+    bool CanPacketReceive(WorldSession* session, WorldPacket const& packet) override
+    {
+        uint16 opcode = packet.GetOpcode();
+        if (opcode != CMSG_ADD_FRIEND && opcode != CMSG_DEL_FRIEND)
+        {
+            return true;
+        }
+
+        // The session's player can change under the world thread during login and logout, so only the
+        // account is captured here.
+        if (!session)
+        {
+            return true;
+        }
+
+        SocialFriendEvent event;
+        event.added = (opcode == CMSG_ADD_FRIEND);
+        event.ownerAccountId = session->GetAccountId();
+        try
+        {
+            WorldPacket data(packet);
+            if (event.added)
+            {
+                data >> event.friendName;
+            }
+            else
+            {
+                data >> event.friendGuid;
+            }
+        }
+        catch (ByteBufferException const&)
+        {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> guard(g_SocialFriendEventsLock);
+        g_SocialFriendEvents.push_back(std::move(event));
+        return true;
     }
 };
 
@@ -1906,9 +5026,15 @@ public:
 
     ChatCommandTable GetCommands() const override
     {
+        static ChatCommandTable bracketCommandTable =
+        {
+            { "stats", HandleStats, SEC_ADMINISTRATOR, Console::Yes },
+            { "trace", HandleTrace, SEC_ADMINISTRATOR, Console::Yes }
+        };
         static ChatCommandTable commandTable =
         {
-            { "reload", HandleReloadConfig, SEC_ADMINISTRATOR, Console::No }
+            { "reload", HandleReloadConfig, SEC_ADMINISTRATOR, Console::No },
+            { "bracket", bracketCommandTable }
         };
         return commandTable;
     }
@@ -1916,24 +5042,104 @@ public:
     static bool HandleReloadConfig(ChatHandler* handler)
     {
         LoadBotLevelBracketsConfig();
+        LoadSocialFriendList();
+        LoadPersistentGuildTracker();
         handler->SendSysMessage("Bot level brackets config reloaded.");
         return true;
     }
+
+    /**
+     * @brief Prints the most recent entries of the decision trace, oldest first.
+     *
+     * @param count How many records to print; defaults to 50, which is also used for 0.
+     */
+    static bool HandleTrace(ChatHandler* handler, Optional<uint32> count)
+    {
+        uint64 total = g_DecisionTrace.GetTotal();
+        uint64 nowMs = GameTime::GetGameTimeMS().count();
+        // ForEachRecent() reads 0 as "every record", which would flood the chat.
+        uint32 requested = count.value_or(0);
+        uint32 shown = std::min<uint32>(requested > 0 ? requested : 50, DECISION_TRACE_CAPACITY);
+        handler->PSendSysMessage("Decision trace: {} decisions recorded, showing the last {}.", total, std::min<uint64>(total, shown));
+        g_DecisionTrace.ForEachRecent(shown, [handler, nowMs](const BracketTraceRecord& record)
+        {
+            handler->SendSysMessage(FormatTraceRecord(record, nowMs));
+        });
+        return true;
+    }
+
+    /**
+     * @brief Prints the live module counters: bracket fill per faction, the pending reset queue,
+     * reset totals and the last distribution pass.
+     *
+     * Everything shown is read from state the module already keeps, so the command is cheap enough
+     * to run on a busy realm.
+     */
+    static bool HandleStats(ChatHandler* handler)
+    {
+        uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+        handler->PSendSysMessage("Bot level brackets: {}.", g_BotLevelBracketsEnabled ? "enabled" : "disabled");
+
+        std::vector<int> counts;
+        for (uint8 teamId = TEAM_ALLIANCE; teamId <= TEAM_HORDE; ++teamId)
+        {
+            const std::vector<LevelRangeConfig>& ranges = (teamId == TEAM_ALLIANCE) ? g_AllianceLevelRanges : g_HordeLevelRanges;
+            uint32 total = GetCensusBracketCounts(teamId, ranges, counts);
+            handler->PSendSysMessage("{} random bots online: {}.", teamId == TEAM_ALLIANCE ? "Alliance" : "Horde", total);
+            for (uint8 i = 0; i < g_NumRanges; ++i)
+            {
+                int desired = static_cast<int>(round((ranges[i].desiredPercent / 100.0) * total));
+                handler->PSendSysMessage("  Range {} ({}-{}): {} / {} desired ({}%).",
+                                         i + 1, ranges[i].lower, ranges[i].upper, counts[i], desired, ranges[i].desiredPercent);
+            }
+        }
+
+        uint32 pending[2] = { 0, 0 };
+        uint32 oldest = now;
+        for (const auto& itr : g_PendingLevelResets.Entries())
+        {
+            ++pending[itr.second.teamId == TEAM_HORDE ? TEAM_HORDE : TEAM_ALLIANCE];
+            oldest = std::min(oldest, itr.second.enqueuedAt);
+        }
+        handler->PSendSysMessage("Pending resets: {} (Alliance {}, Horde {}), oldest waiting {}s. Staged resets in progress: {}. Handed to map threads: {}.",
+                                 g_PendingLevelResets.Size(), pending[TEAM_ALLIANCE], pending[TEAM_HORDE], now - oldest,
+                                 g_StagedBotResets.size(), g_MapThreadResetsInFlight.size());
+        handler->PSendSysMessage("Resets since start: {} done, {} dropped; {} reset cycles held back by the rate limit.",
+                                 g_Stats.resetsDone, g_Stats.resetsDropped, g_Stats.resetsRateLimited);
+        handler->PSendSysMessage("Distribution passes: {} started, {} completed, {} skipped by the census.",
+                                 g_Stats.scansStarted, g_Stats.scansCompleted, g_Stats.scansSkipped);
+        if (g_Stats.scansCompleted > 0)
+        {
+            handler->PSendSysMessage("Last pass: {}s ago, {} bots, {} flagged, {} ms of work over {} ms.",
+                                     now - g_Stats.lastScanFinishedAt, g_Stats.lastScanBots, g_Stats.lastScanFlagged,
+                                     g_Stats.lastScanWorkMs, g_Stats.lastScanWallMs);
+        }
+        if (g_DistributionScan.phase != SCAN_PHASE_IDLE)
+        {
+            handler->PSendSysMessage("A distribution pass is in progress ({} of {} bots collected).",
+                                     g_DistributionScan.cursor, g_DistributionScan.botGuids.size());
+        }
+        return true;
+    }
 };
 
 // -----------------------------------------------------------------------------
 // ENTRY POINT: Register the Bot Level Distribution Module
 // -----------------------------------------------------------------------------
 /**
- * @brief Registers the world, player, and command scripts for the Player Bot Level Brackets module.
+ * @brief Registers the world, player, map, guild, group, server and command scripts for the Player Bot Level Brackets module.
  *
  * This function instantiates and adds the BotLevelBracketsWorldScript, BotLevelBracketsPlayerScript,
- * and BotLevelBracketsCommandScript to the script system, enabling custom logic and commands
+ * BotLevelBracketsMapScript, BotLevelBracketsGuildScript, BotLevelBracketsGroupScript, BotLevelBracketsServerScript and BotLevelBracketsCommandScript to the script system, enabling custom logic and commands
  * for player bot level brackets within the game world.
  */
 void Addmod_player_bot_level_bracketsScripts()
 {
     new BotLevelBracketsWorldScript();
     new BotLevelBracketsPlayerScript();
+    new BotLevelBracketsMapScript();
+    new BotLevelBracketsGuildScript();
+    new BotLevelBracketsGroupScript();
+    new BotLevelBracketsServerScript();
     new BotLevelBracketsCommandScript();
 }
@@ -1,7 +1,31 @@
 #ifndef MOD_BOT_LEVEL_BRACKETS_H
 #define MOD_BOT_LEVEL_BRACKETS_H
 
+#include "Define.h"
+
 // Registers the Bot Level Brackets module scripts.
 void Addmod_player_bot_level_bracketsScripts();
 
+/**
+ * @brief Picks a level for a random bot that is about to be created or re-rolled, steering it toward
+ * the brackets of its faction that are short of bots.
+ *
+ * Meant to replace a plain random level roll, e.g. in RandomPlayerbotMgr or PlayerbotFactory:
+ *
+ *     uint8 level = BotLevelBracketsSampleLevel(bot->GetTeamId(), bot->getClass());
+ *     if (!level)
+ *         level = urand(minLevel, maxLevel);
+ *
+ * Nothing in AzerothCore or playerbots calls this by itself. Without such a call site, the module
+ * uses it only for bots logging in for the first time, with BotLevelBrackets.SampleNewBotLevels.
+ *
+ * Must be called from the world thread.
+ *
+ * @param teamId The bot's faction (TEAM_ALLIANCE or TEAM_HORDE).
+ * @param classId The bot's class; Death Knights are never given a level below 55.
+ * @return uint8 The level, or 0 if the module is disabled or no bracket is short of bots, in which
+ *         case the caller should fall back to its own roll.
+ */
+uint8 BotLevelBracketsSampleLevel(uint8 teamId, uint8 classId);
+
 #endif // MOD_BOT_LEVEL_BRACKETS_H